@@ -0,0 +1,37 @@
+#include "aiAgents.hpp"
+
+int AIAgents::add(Side s, const sf::Vector2f& pos, float r) {
+    int a = size();
+    resize(a + 1);
+    position[a] = pos;
+    prevPosition[a] = pos;
+    radius[a] = r;
+    side[a] = s;
+    return a;
+}
+
+void AIAgents::resize(int n) {
+    const std::size_t count = static_cast<std::size_t>(n);
+    position.resize(count);
+    prevPosition.resize(count);
+    radius.resize(count, 18.f);
+    side.resize(count, Side::AI);
+    hasSeed.resize(count, 0);
+    hasProduct.resize(count, 0);
+    carriedSeed.resize(count, CropType::None);
+    state.resize(count, AIState::SelectGoal);
+    targetCrop.resize(count, CropType::None);
+    path.resize(count);
+    pathIndex.resize(count, 0);
+    pathRequest.resize(count, -1);
+    bounceDir.resize(count, 1.f);
+    idleTimer.resize(count, 0.f);
+}
+
+void AIAgents::resetGoal(int a) {
+    path[a].clear();
+    pathIndex[a] = 0;
+    pathRequest[a] = -1;
+    targetCrop[a] = CropType::None;
+    state[a] = AIState::SelectGoal;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include <cstdint>
+#include "farmGrid.hpp"
+
+// AI State machine for the AI farmers
+enum class AIState : std::uint8_t {
+    SelectGoal,
+    GoToSeeds,
+    PickSeeds,
+    GoToPlant,
+    Plant,
+    WaitForGrowth,
+    Harvest,
+    GoToMarket,
+    GoToTrash,
+    Sell,
+    Idle
+};
+
+// Side of the divider a farmer works on (and scores for)
+enum class Side : std::uint8_t { Player, AI };
+
+// All AI farmers of a match, one entry per agent in each array (agent a is index a
+// everywhere). The sim updates them in one pass over the arrays.
+struct AIAgents {
+    std::vector<sf::Vector2f> position;     // centre, in play-area units
+    std::vector<sf::Vector2f> prevPosition; // position before the last step (for render interpolation)
+    std::vector<float> radius;
+    std::vector<Side> side;
+
+    std::vector<std::uint8_t> hasSeed;
+    std::vector<std::uint8_t> hasProduct;
+    std::vector<CropType> carriedSeed;
+
+    std::vector<AIState> state;
+    std::vector<CropType> targetCrop;    // what the agent is currently trying to produce
+    std::vector<std::vector<int>> path;  // sequence of tile indices (A* result)
+    std::vector<int> pathIndex;          // next waypoint index in path
+    std::vector<int> pathRequest;        // tile a path was asked for this step, -1 if none
+    std::vector<float> bounceDir;        // 1 = move right, -1 = move left
+    std::vector<float> idleTimer;        // time spent in Idle before re-evaluating
+
+    int size() const { return static_cast<int>(position.size()); }
+
+    // Append an agent standing at pos with nothing in hand; returns its index
+    int add(Side s, const sf::Vector2f& pos, float r = 18.f);
+    // Set the number of agents (new ones are default-constructed, see add)
+    void resize(int n);
+    void clear() { resize(0); }
+
+    // Forget the current task so the agent picks a new one next step
+    void resetGoal(int a);
+};
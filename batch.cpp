@@ -0,0 +1,205 @@
+// Headless batch runner: plays many AI-vs-scripted-player matches per level on all cores
+// and prints win rates, score distributions and requests-completed histograms (after the
+// farm grid's simulation bytes per tile).
+//
+//   Games-Engineering-Batch [--level N]... [--matches M] [--seed S] [--threads T]
+//                           [--time SECONDS] [--requests N] [--max-qty Q]
+//                           [--ai N] [--helpers N] [--open N] [--endless]
+//                           [--path astar|astar8|jps|jps8|hpa|dstar] [--no-flow] [--path-cache N]
+//                           [--no-smooth] [--out FILE]
+//
+// --ai sets the number of AI farmers on the right side, --helpers adds AI farmers to the
+// scripted player's side. --open keeps N requests open at once (a market rush).
+// --endless never runs out of requests, so only --time ends a match (soak runs).
+// --path picks the AI farmers' path search; --no-flow makes them search paths to seed
+// boxes, markets and trash too instead of following the precomputed flow fields.
+// --path-cache sets how many path search results each match remembers (0: none).
+// --no-smooth makes the AI farmers walk their paths tile centre to tile centre instead of
+// in straight segments.
+//
+// Match i of a level uses seed S + i, so a run (and any single match of it) can be
+// reproduced; results do not depend on the number of threads.
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include "gameSim.hpp"
+#include "scriptedPlayer.hpp"
+
+struct MatchResult {
+    Winner winner = Winner::None;
+    int playerScore = 0;
+    int aiScore = 0;
+    int playerRequests = 0;
+    int aiRequests = 0;
+    std::uint32_t ticks = 0;
+    PathCache::Stats paths;
+};
+
+struct BatchOptions {
+    std::vector<int> levels;
+    int matches = 1000;
+    std::uint32_t seed = 1;
+    int threads = 0;
+    MatchRules rules;
+    std::string outPath;
+};
+
+static MatchResult playMatch(int levelID, std::uint32_t seed, const MatchRules& rules) {
+    GameSim sim(levelID, seed, rules);
+    ScriptedPlayer player;
+
+    // the timer always ends a match; the cap only guards against a broken level
+    const float maxSeconds = std::max(3600.f, 2.f * rules.matchSeconds);
+    const std::uint32_t maxTicks = static_cast<std::uint32_t>(maxSeconds / GameSim::fixedStep);
+    while (!sim.isGameOver() && sim.getTick() < maxTicks) {
+        sim.step(player.think(sim));
+    }
+
+    MatchResult r;
+    r.winner = sim.getWinner();
+    r.playerScore = sim.getPlayerScore();
+    r.aiScore = sim.getAIScore();
+    r.playerRequests = sim.getPlayerRequestsCompleted();
+    r.aiRequests = sim.getAIRequestsCompleted();
+    r.ticks = sim.getTick();
+    r.paths = sim.getPathCacheStats();
+    return r;
+}
+
+// Play all matches of a level; each worker takes the next match number until none are left
+static std::vector<MatchResult> runLevel(int levelID, const BatchOptions& opt) {
+    std::vector<MatchResult> results(opt.matches);
+    std::atomic<int> next{0};
+
+    auto worker = [&]() {
+        for (int i = next++; i < opt.matches; i = next++) {
+            results[i] = playMatch(levelID, opt.seed + static_cast<std::uint32_t>(i), opt.rules);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < opt.threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    return results;
+}
+
+static void printScores(std::ostream& out, const char* who, std::vector<int> scores) {
+    std::sort(scores.begin(), scores.end());
+    double mean = 0.0;
+    for (int s : scores) mean += s;
+    mean /= scores.size();
+    double var = 0.0;
+    for (int s : scores) var += (s - mean) * (s - mean);
+    double stddev = std::sqrt(var / scores.size());
+
+    auto pct = [&](double p) { return scores[static_cast<size_t>(p * (scores.size() - 1) + 0.5)]; };
+    out << "  " << who << " score: mean " << mean << ", stddev " << stddev
+        << ", min " << scores.front() << ", p10 " << pct(0.1) << ", median " << pct(0.5)
+        << ", p90 " << pct(0.9) << ", max " << scores.back() << "\n";
+}
+
+static void printHistogram(std::ostream& out, const char* who, const std::vector<MatchResult>& results, bool player) {
+    int maxValue = 0;
+    for (const auto& r : results) maxValue = std::max(maxValue, player ? r.playerRequests : r.aiRequests);
+    std::vector<int> counts(maxValue + 1, 0);
+    for (const auto& r : results) counts[player ? r.playerRequests : r.aiRequests]++;
+
+    out << "  " << who << " requests completed:\n";
+    for (int v = 0; v <= maxValue; ++v) {
+        double share = 100.0 * counts[v] / results.size();
+        out << "    " << v << ": " << counts[v] << " (" << share << "%) "
+            << std::string(static_cast<size_t>(share / 2.0 + 0.5), '#') << "\n";
+    }
+}
+
+static void report(std::ostream& out, int levelID, const BatchOptions& opt, const std::vector<MatchResult>& results, double ms) {
+    int wins[4] = { 0, 0, 0, 0 };
+    std::vector<int> playerScores, aiScores;
+    double ticks = 0.0;
+    PathCache::Stats paths;
+    for (const auto& r : results) {
+        paths.lookups += r.paths.lookups;
+        paths.hits += r.paths.hits;
+        paths.searchMicros += r.paths.searchMicros;
+        paths.savedMicros += r.paths.savedMicros;
+        wins[static_cast<int>(r.winner)]++;
+        playerScores.push_back(r.playerScore);
+        aiScores.push_back(r.aiScore);
+        ticks += r.ticks;
+    }
+    const double n = static_cast<double>(results.size());
+
+    out << "=== Level " << levelID << ": " << results.size() << " matches, seeds " << opt.seed << ".."
+        << opt.seed + results.size() - 1 << " ===\n";
+    out << "  " << ms << " ms on " << opt.threads << " threads (" << results.size() / (ms / 1000.0)
+        << " matches/s, " << ticks / (ms / 1000.0) << " steps/s)\n";
+    out << "  wins: player " << 100.0 * wins[static_cast<int>(Winner::Player)] / n << "%, AI "
+        << 100.0 * wins[static_cast<int>(Winner::AI)] / n << "%, tie "
+        << 100.0 * wins[static_cast<int>(Winner::Tie)] / n << "%\n";
+    if (paths.lookups > 0) {
+        out << "  path cache: " << 100.0 * paths.hitRate() << "% of " << paths.lookups << " searches hit, "
+            << paths.searchMicros / 1000.0 << " ms searching, " << paths.savedMicros / 1000.0 << " ms saved\n";
+    }
+    printScores(out, "player", playerScores);
+    printScores(out, "AI", aiScores);
+    printHistogram(out, "player", results, true);
+    printHistogram(out, "AI", results, false);
+}
+
+int main(int argc, char** argv) {
+    BatchOptions opt;
+    opt.rules.log = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--level" && hasValue) opt.levels.push_back(std::atoi(argv[++i]));
+        else if (arg == "--matches" && hasValue) opt.matches = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) opt.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--threads" && hasValue) opt.threads = std::atoi(argv[++i]);
+        else if (arg == "--time" && hasValue) opt.rules.matchSeconds = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--requests" && hasValue) opt.rules.numRequests = std::atoi(argv[++i]);
+        else if (arg == "--max-qty" && hasValue) opt.rules.maxQty = std::atoi(argv[++i]);
+        else if (arg == "--ai" && hasValue) opt.rules.aiFarmers = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--helpers" && hasValue) opt.rules.aiHelpers = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--open" && hasValue) opt.rules.openRequests = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--endless") opt.rules.endless = true;
+        else if (arg == "--path" && hasValue && parsePathAlgorithm(argv[i + 1], opt.rules.pathAlgorithm)) ++i;
+        else if (arg == "--no-flow") opt.rules.flowFields = false;
+        else if (arg == "--path-cache" && hasValue) opt.rules.pathCacheSize = std::atoi(argv[++i]);
+        else if (arg == "--no-smooth") opt.rules.smoothPaths = false;
+        else if (arg == "--out" && hasValue) opt.outPath = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--level N]... [--matches M] [--seed S] [--threads T]\n"
+                      << "       [--time SECONDS] [--requests N] [--max-qty Q]\n"
+                      << "       [--ai N] [--helpers N] [--open N] [--endless]\n"
+                      << "       [--path astar|astar8|jps|jps8|hpa|dstar] [--no-flow] [--path-cache N]\n"
+                      << "       [--no-smooth] [--out FILE]\n";
+            return 1;
+        }
+    }
+    if (opt.levels.empty()) opt.levels.push_back(1);
+    if (opt.matches <= 0) return 0;
+    if (opt.threads <= 0) opt.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::ofstream file;
+    if (!opt.outPath.empty()) {
+        file.open(opt.outPath);
+        if (!file) {
+            std::cerr << "[ERROR] Cannot write " << opt.outPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = file.is_open() ? static_cast<std::ostream&>(file) : std::cout;
+
+    out << "farm grid: " << FarmGrid::bytesPerTile() << " bytes of simulation data per tile\n";
+    for (int levelID : opt.levels) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<MatchResult> results = runLevel(levelID, opt);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        report(out, levelID, opt, results, ms);
+    }
+    return 0;
+}
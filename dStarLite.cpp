@@ -0,0 +1,156 @@
+#include "dStarLite.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+constexpr int DStarLite::unreachable;
+
+void DStarLite::clear() {
+    start = goal = lastStart = -1;
+    km = 0;
+    changed = false;
+    nodes.clear();
+    open = decltype(open)();
+}
+
+void DStarLite::plan(const PathGrid& g, int s, int t) {
+    clear();
+    grid = g;
+    start = lastStart = s;
+    goal = t;
+    Node& n = node(goal);
+    n.rhs = 0;
+    n.key = calcKey(goal, n);
+    n.queued = true;
+    open.push({n.key, goal});
+}
+
+DStarLite::Node& DStarLite::node(int tile) {
+    return nodes[tile];
+}
+
+int DStarLite::gOf(int tile) const {
+    auto it = nodes.find(tile);
+    return it == nodes.end() ? unreachable : it->second.g;
+}
+
+int DStarLite::heuristic(int a, int b) const {
+    return straightCost * (std::abs(a % grid.cols - b % grid.cols) + std::abs(a / grid.cols - b / grid.cols));
+}
+
+DStarLite::Key DStarLite::calcKey(int tile, const Node& n) const {
+    const int m = std::min(n.g, n.rhs);
+    if (m == unreachable) return {unreachable, unreachable};
+    return {m + heuristic(start, tile) + km, m};
+}
+
+// The 4 neighbours inside the grid
+template <class F> void DStarLite::forNeighbours(int tile, F f) const {
+    const int x = tile % grid.cols, y = tile / grid.cols;
+    if (x > 0) f(tile - 1);
+    if (x + 1 < grid.cols) f(tile + 1);
+    if (y > 0) f(tile - grid.cols);
+    if (y + 1 < grid.rows) f(tile + grid.cols);
+}
+
+void DStarLite::updateVertex(int tile) {
+    Node& n = node(tile);
+    if (tile != goal) {
+        // stepping onto a tile costs straightCost if it can be entered; leaving one is free
+        // of rules (the walker may stand on a tile that got blocked)
+        int best = unreachable;
+        forNeighbours(tile, [&](int v) {
+            if (!canEnter(v)) return;
+            const int gv = gOf(v);
+            if (gv != unreachable) best = std::min(best, gv + straightCost);
+        });
+        n.rhs = best;
+    }
+    n.queued = n.g != n.rhs;
+    if (n.queued) {
+        n.key = calcKey(tile, n);
+        open.push({n.key, tile});
+    }
+}
+
+void DStarLite::computeShortestPath(PathStats* stats) {
+    for (;;) {
+        // drop entries of tiles taken off the queue or re-queued with another key
+        while (!open.empty()) {
+            auto it = nodes.find(open.top().second);
+            if (it->second.queued && it->second.key == open.top().first) break;
+            open.pop();
+        }
+        const Node& s = node(start);
+        const Key startKey = calcKey(start, s);
+        if (open.empty() || (open.top().first >= startKey && s.rhs == s.g)) return;
+
+        const Key oldKey = open.top().first;
+        const int u = open.top().second;
+        open.pop();
+        Node& n = node(u);
+        n.queued = false;
+        if (stats) stats->expanded++;
+
+        const Key newKey = calcKey(u, n);
+        if (oldKey < newKey) {
+            // the walker moved since this entry was made
+            n.key = newKey;
+            n.queued = true;
+            open.push({newKey, u});
+        } else if (n.g > n.rhs) {
+            n.g = n.rhs;
+            if (canEnter(u)) forNeighbours(u, [&](int p) { if (canEnter(p) || p == start) updateVertex(p); });
+        } else {
+            n.g = unreachable;
+            updateVertex(u);
+            if (canEnter(u)) forNeighbours(u, [&](int p) { if (canEnter(p) || p == start) updateVertex(p); });
+        }
+    }
+}
+
+void DStarLite::moveTo(int s) {
+    if (!isActive() || s == start) return;
+    start = s;
+    km += heuristic(lastStart, start);
+    lastStart = start;
+}
+
+void DStarLite::tileChanged(int tile) {
+    if (!isActive() || tile < 0 || tile >= grid.cols * grid.rows) return;
+    changed = true;
+    // the costs of stepping onto tile changed: everything next to it is re-costed, and
+    // a tile that just opened gets a cost of its own
+    if (canEnter(tile)) updateVertex(tile);
+    forNeighbours(tile, [&](int p) { if (canEnter(p) || p == start) updateVertex(p); });
+}
+
+std::vector<int> DStarLite::path(PathStats* stats) {
+    std::vector<int> result;
+    path(result, stats);
+    return result;
+}
+
+bool DStarLite::path(std::vector<int>& out, PathStats* stats) {
+    changed = false;
+    out.clear();
+    if (!isActive() || start < 0) return false;
+    if (start == goal) { out.push_back(start); return true; }
+    if (!canEnter(start) && !node(start).queued) updateVertex(start);
+    computeShortestPath(stats);
+    if (gOf(start) == unreachable) return false;
+
+    // walk down the costs from the start
+    out.push_back(start);
+    for (int cur = start, steps = 0; cur != goal; ++steps) {
+        int best = -1, bestCost = unreachable;
+        forNeighbours(cur, [&](int v) {
+            if (!canEnter(v)) return;
+            const int gv = gOf(v);
+            if (gv != unreachable && gv + straightCost < bestCost) { bestCost = gv + straightCost; best = v; }
+        });
+        if (best < 0 || steps > static_cast<int>(nodes.size())) { out.clear(); return false; }
+        out.push_back(best);
+        cur = best;
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include "gridPath.hpp"
+
+// Incremental path search (D* Lite, 4 directions) for one walker and one goal. The
+// search runs backwards from the goal and keeps its tree, so when tiles change only the
+// part of the tree that depended on them is searched again, and the walker may have
+// moved on in between. Memory grows with the tiles searched, not with the grid.
+class DStarLite {
+public:
+    // Start over: search from start to goal on grid (kept by value; its walkable array
+    // must stay where it is)
+    void plan(const PathGrid& grid, int start, int goal);
+    void clear();
+    bool isActive() const { return goal >= 0; }
+    int getGoal() const { return goal; }
+
+    // The walker is on tile start now
+    void moveTo(int start);
+    // The walkability of tile changed (the grid already shows the new value)
+    void tileChanged(int tile);
+    // Tiles changed since the last path()
+    bool hasChanges() const { return changed; }
+
+    // Tiles from the start to the goal (both included), empty if it can't be reached;
+    // searches only what the changes since the last call made necessary
+    std::vector<int> path(PathStats* stats = nullptr);
+    // Same, into out (replacing what's there, reusing its storage); false if the goal
+    // can't be reached
+    bool path(std::vector<int>& out, PathStats* stats = nullptr);
+
+private:
+    using Key = std::pair<int, int>;
+    static constexpr int unreachable = std::numeric_limits<int>::max();
+
+    struct Node {
+        int g = unreachable;
+        int rhs = unreachable; // cost through the best neighbour, one step ahead of g
+        Key key{0, 0};
+        bool queued = false;
+    };
+
+    Node& node(int tile);
+    int gOf(int tile) const;
+    int heuristic(int a, int b) const;
+    Key calcKey(int tile, const Node& n) const;
+    bool canEnter(int tile) const { return grid.open(tile % grid.cols, tile / grid.cols); }
+    void updateVertex(int tile);
+    void computeShortestPath(PathStats* stats);
+    template <class F> void forNeighbours(int tile, F f) const;
+
+    PathGrid grid;
+    int start = -1;
+    int goal = -1;
+    int lastStart = -1; // start when the key modifier was last raised
+    int km = 0;         // key modifier: how far the walker has moved since the plan
+    bool changed = false;
+
+    std::unordered_map<int, Node> nodes;
+    std::priority_queue<std::pair<Key, int>, std::vector<std::pair<Key, int>>, std::greater<>> open; // stale entries skipped
+};
@@ -0,0 +1,40 @@
+#include "effectPool.hpp"
+
+constexpr int EffectPool::capacity;
+
+void EffectPool::spawn(EffectType type, int tile, CropType crop, float duration) {
+    TileEffect* slot = nullptr;
+
+    for (int i = 0; i < count; ++i) {
+        if (effects[i].tile == tile && effects[i].type == type) { slot = &effects[i]; break; }
+    }
+
+    if (!slot) {
+        if (count < capacity) {
+            slot = &effects[count++];
+        } else {
+            slot = &effects[0];
+            for (int i = 1; i < count; ++i) {
+                if (effects[i].timeLeft < slot->timeLeft) slot = &effects[i];
+            }
+        }
+    }
+
+    slot->tile = tile;
+    slot->type = type;
+    slot->crop = crop;
+    slot->duration = duration;
+    slot->timeLeft = duration;
+}
+
+void EffectPool::update(float dt) {
+    int i = 0;
+    while (i < count) {
+        effects[i].timeLeft -= dt;
+        if (effects[i].timeLeft <= 0.f) {
+            effects[i] = effects[--count]; // swap-remove, order does not matter
+        } else {
+            ++i;
+        }
+    }
+}
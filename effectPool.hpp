@@ -0,0 +1,42 @@
+#pragma once
+#include <array>
+#include "farmGrid.hpp"
+
+// Short tile visuals triggered by the sim (a crop sold at a market, a seed taken from a box)
+enum class EffectType : std::uint8_t { Sold, SeedTaken };
+
+struct TileEffect {
+    int tile = -1;
+    float timeLeft = 0.f;  // remaining seconds
+    float duration = 0.f;  // total seconds, for fading
+    CropType crop = CropType::None;
+    EffectType type = EffectType::Sold;
+};
+
+// Fixed-capacity pool holding only the live effects, packed at the front.
+// Update and draw walk just those; nothing is allocated after construction.
+class EffectPool {
+public:
+    static constexpr int capacity = 64;
+
+    // Start an effect; re-triggering the same effect on the same tile restarts it.
+    // When the pool is full the effect closest to finishing is replaced.
+    void spawn(EffectType type, int tile, CropType crop, float duration);
+
+    // Age all live effects and drop the finished ones
+    void update(float dt);
+
+    void clear() { count = 0; }
+
+    // Put back an effect exactly as it was (snapshot restore); ignored when full
+    void restore(const TileEffect& e) { if (count < capacity) effects[count++] = e; }
+
+    int size() const { return count; }
+    const TileEffect& operator[](int i) const { return effects[i]; }
+    const TileEffect* begin() const { return effects.data(); }
+    const TileEffect* end() const { return effects.data() + count; }
+
+private:
+    std::array<TileEffect, capacity> effects;
+    int count = 0;
+};
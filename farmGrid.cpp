@@ -0,0 +1,17 @@
+#include "farmGrid.hpp"
+
+void FarmGrid::resize(int newCols, int newRows) {
+    cols = newCols;
+    rows = newRows;
+    const std::size_t n = static_cast<std::size_t>(cols) * rows;
+
+    state.assign(n, TileState::Empty);
+    type.assign(n, GroundType::Empty);
+    crop.assign(n, CropType::None);
+    walkable.assign(n, 1);
+    readyTick.assign(n, 0);
+}
+
+std::size_t FarmGrid::bytesPerTile() {
+    return sizeof(TileState) + sizeof(GroundType) + sizeof(CropType) + sizeof(std::uint8_t) + sizeof(std::uint32_t);
+}
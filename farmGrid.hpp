@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//crop types
+enum class CropType : std::uint8_t { None, Carrot, Tomato, Lettuce, Corn, Potato };
+
+// State of a tile
+enum class TileState : std::uint8_t { Empty, Grown, Seeded, Watered, Suned, Marketed };
+
+enum class GroundType : std::uint8_t { Empty, Soil, Wall, Market, Seeds, Water, Sun, Trash };
+
+// Simulation data of the farm grid, stored as one array per field (struct of arrays).
+// The per-step loops only touch the few bytes they need, so a whole field of a large
+// grid stays in cache; tile shapes live in the view (Game) and never come near here.
+struct FarmGrid {
+    int cols = 0;
+    int rows = 0;
+
+    // Read by growth, AI scans and pathfinding (8 bytes per tile)
+    std::vector<TileState> state;
+    std::vector<GroundType> type;
+    std::vector<CropType> crop;
+    std::vector<std::uint8_t> walkable;
+    std::vector<std::uint32_t> readyTick; // sim tick at which a planted crop is grown
+
+    // (Re)create an empty, walkable grid of the given size
+    void resize(int newCols, int newRows);
+
+    int size() const { return cols * rows; }
+
+    // Bytes of simulation data stored per tile
+    static std::size_t bytesPerTile();
+};
@@ -0,0 +1,82 @@
+#include "flowField.hpp"
+#include <queue>
+#include <limits>
+#include <functional>
+
+constexpr std::uint8_t FlowField::atGoal;
+constexpr std::uint8_t FlowField::noGoal;
+
+namespace {
+// neighbours: 4 straight, then the diagonals (as in the path searches)
+const int dx[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+const int dy[8] = {0, 0, 1, -1, 1, 1, -1, -1};
+const std::uint8_t opposite[8] = {1, 0, 3, 2, 7, 6, 5, 4};
+}
+
+void FlowField::build(const PathGrid& g, const std::vector<int>& goals, bool diag) {
+    cols = g.cols;
+    diagonal = diag;
+    goalCount = 0;
+    const int N = g.rows * g.cols;
+    step.assign(static_cast<std::size_t>(N), noGoal);
+
+    std::vector<int> dist(static_cast<std::size_t>(N), std::numeric_limits<int>::max());
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<>> open;
+    for (int t : goals) {
+        if (t < 0 || t >= N || !g.open(t % g.cols, t / g.cols) || dist[t] == 0) continue;
+        dist[t] = 0;
+        step[t] = atGoal;
+        goalCount++;
+        open.push({0, t});
+    }
+    if (goalCount == 0) {
+        step = std::vector<std::uint8_t>(); // nothing to walk to: no memory either
+        return;
+    }
+
+    const int dirs = diag ? 8 : 4;
+    while (!open.empty()) {
+        const int d = open.top().first;
+        const int cur = open.top().second;
+        open.pop();
+        if (d > dist[cur]) continue; // stale entry
+
+        const int cx = cur % g.cols, cy = cur / g.cols;
+        for (int k = 0; k < dirs; ++k) {
+            const int nx = cx + dx[k], ny = cy + dy[k];
+            if (!g.open(nx, ny)) continue;
+            if (k >= 4 && (!g.open(nx, cy) || !g.open(cx, ny))) continue; // no corner cutting
+            const int n = ny * g.cols + nx;
+            const int nd = d + (k >= 4 ? diagonalCost : straightCost);
+            if (nd < dist[n]) {
+                dist[n] = nd;
+                step[n] = opposite[k]; // from n, step back to cur
+                open.push({nd, n});
+            }
+        }
+    }
+}
+
+int FlowField::next(int tile) const {
+    if (tile < 0 || tile >= static_cast<int>(step.size())) return -1;
+    const std::uint8_t s = step[static_cast<std::size_t>(tile)];
+    if (s == noGoal) return -1;
+    if (s == atGoal) return tile;
+    return tile + dy[s] * cols + dx[s];
+}
+
+std::vector<int> FlowField::trace(int start) const {
+    std::vector<int> path;
+    trace(start, path);
+    return path;
+}
+
+void FlowField::trace(int start, std::vector<int>& path) const {
+    path.clear();
+    if (!reaches(start)) return;
+    path.push_back(start);
+    for (int t = start; step[static_cast<std::size_t>(t)] != atGoal;) {
+        t = next(t);
+        path.push_back(t);
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "gridPath.hpp"
+
+// Direction to the nearest of a fixed set of goal tiles, for every tile of a PathGrid
+// (a Dijkstra search run backwards from all goals at once). Built once and read by any
+// number of farmers: the next step toward the nearest goal is one lookup, a whole path
+// is as long to read as it is to walk. One byte per tile.
+class FlowField {
+public:
+    // Search the grid from goals (tiles that aren't open are skipped); diagonal as in
+    // the 8-directional path searches (no corner cutting)
+    void build(const PathGrid& grid, const std::vector<int>& goals, bool diagonal);
+
+    // Next tile toward the nearest goal: tile itself on a goal, -1 if no goal is reachable
+    int next(int tile) const;
+    bool reaches(int tile) const { return next(tile) >= 0; }
+
+    // Tiles from start to the nearest goal (both included), empty if none is reachable
+    std::vector<int> trace(int start) const;
+    // Same, into path (replacing what's there, reusing its storage)
+    void trace(int start, std::vector<int>& path) const;
+
+    bool isDiagonal() const { return diagonal; }
+    int getGoalCount() const { return goalCount; }
+
+private:
+    static constexpr std::uint8_t atGoal = 8;
+    static constexpr std::uint8_t noGoal = 0xFF;
+
+    int cols = 0;
+    bool diagonal = false;
+    int goalCount = 0;
+    std::vector<std::uint8_t> step; // per tile: neighbour to step to (0-7), atGoal or noGoal
+};
@@ -1,311 +1,63 @@
 #include "game.hpp"
 
-// Duration for the temporary sold visual (seconds)
-static constexpr float sold_visual_temp = 0.8f;
-// Duration for the temporary seed-taken visual (seconds)
-static constexpr float seed_take_visual_temp = 0.6f;
-
-// Convert position to tile index (or -1 if outside)
-int Game::tileIndexFromPos(const sf::Vector2f& pos) const {
-    // pos relative to gridOrigin
-    float relX = pos.x - gridOrigin.x;
-    float relY = pos.y - gridOrigin.y;
-    if (relX < 0 || relY < 0) return -1;
-
-    // compute tile size from your existing layout:
-    float fullWidth = static_cast<float>(window.getSize().x);
-    float playTop = board.box.getPosition().y + board.box.getSize().y;
-    float playLeft = 0.f;
-    float playRight = fullWidth;
-    float playBottom = static_cast<float>(window.getSize().y);
-
-    float playWidth = playRight - playLeft;
-    float playHeight = playBottom - playTop;
-
-    float tileW = playWidth / gridCols;
-    float tileH = playHeight / gridRows;
-
-    int col = static_cast<int>(relX / tileW);
-    int row = static_cast<int>(relY / tileH);
-
-    if (col < 0 || col >= gridCols || row < 0 || row >= gridRows) return -1;
-    return row * gridCols + col;
-}
-
-// Tile center coordinates
-sf::Vector2f Game::tileCenter(int index) const {
-    if (index < 0 || index >= static_cast<int>(farm.size())) return {0.f, 0.f};
-    const FarmTile& t = farm[index];
-    auto pos = t.rect.getPosition();
-    auto size = t.rect.getSize();
-    return { pos.x + size.x * 0.5f, pos.y + size.y * 0.5f };
-}
-
-bool Game::isTileWalkable(int index) const {
-    if (index < 0 || index >= static_cast<int>(farm.size())) return false;
-    return farm[index].walkable;
-}
-
-
-// Simple A* on the grid using Manhattan distance
-std::vector<int> Game::findPathAStar(int startIdx, int goalIdx) {
-    std::vector<int> emptyPath;
-    if (startIdx < 0 || goalIdx < 0) return emptyPath;
-    if (startIdx == goalIdx) return {startIdx};
-
-    auto heuristic = [&](int a, int b)->int {
-        int ax = a % gridCols, ay = a / gridCols;
-        int bx = b % gridCols, by = b / gridCols;
-        return std::abs(ax - bx) + std::abs(ay - by);
-    };
-
-    struct Node {
-        int idx;
-        int f;
-        int g;
-        int cameFrom;
-    };
-
-    const int N = gridRows * gridCols;
-    const int INF = std::numeric_limits<int>::max();
-
-    std::vector<int> gScore(N, INF);
-    std::vector<int> fScore(N, INF);
-    std::vector<int> cameFrom(N, -1);
-    std::vector<char> closed(N, 0);
-
-    auto pushToOpen = [&](std::priority_queue<std::pair<int,int>,
-                        std::vector<std::pair<int,int>>, std::greater<>> &pq, int idx, int f){
-        pq.push({f, idx});
-    };
-
-    std::priority_queue<std::pair<int,int>,
-        std::vector<std::pair<int,int>>, std::greater<>> openSet;
-
-    gScore[startIdx] = 0;
-    fScore[startIdx] = heuristic(startIdx, goalIdx);
-    pushToOpen(openSet, startIdx, fScore[startIdx]);
-
-    while (!openSet.empty()) {
-        int current = openSet.top().second;
-        openSet.pop();
-
-        if (closed[current]) continue;
-        if (current == goalIdx) {
-            // reconstruct path
-            std::vector<int> path;
-            int cur = current;
-            while (cur != -1) {
-                path.push_back(cur);
-                cur = cameFrom[cur];
-            }
-            std::reverse(path.begin(), path.end());
-            return path;
-        }
-        closed[current] = 1;
-
-        int cx = current % gridCols;
-        int cy = current / gridCols;
-
-        // neighbors 4-dir
-        const int dx[4] = {1,-1,0,0};
-        const int dy[4] = {0,0,1,-1};
-
-        for (int k = 0; k < 4; ++k) {
-            int nx = cx + dx[k];
-            int ny = cy + dy[k];
-            if (nx < 0 || nx >= gridCols || ny < 0 || ny >= gridRows) continue;
-            int nidx = ny * gridCols + nx;
-            if (!isTileWalkable(nidx)) continue;
-
-            // Restrict A* to the right side of the centre path 
-            // Compute the right edge X of the centrePath and skip any neighbour whose tile center is left of (or on) that edge.
-            {
-                sf::FloatRect wall = centerPath.getGlobalBounds();
-                float wallRightX = wall.left + wall.width;
-                sf::Vector2f tc = tileCenter(nidx);
-                if (tc.x <= wallRightX) continue; // skip tiles on or left of the divider
-            }
-
-            int tentativeG = gScore[current] + 1; // cost = 1 per step
-            if (tentativeG < gScore[nidx]) {
-                cameFrom[nidx] = current;
-                gScore[nidx] = tentativeG;
-                fScore[nidx] = tentativeG + heuristic(nidx, goalIdx);
-                pushToOpen(openSet, nidx, fScore[nidx]);
-            }
-        }
-    }
-
-    // no path found
-    return emptyPath;
-}
-
-
-// Helper to convert from char in level file to GroundType and CropType
-static void charToGroundType(char c, GroundType& gt, CropType& ct) {
-    gt = GroundType::Empty;
-    ct = CropType::None;
-
-    switch (c) {
-    case 'T': 
-        gt = GroundType::Soil;
-        break;
-        // Seed boxes
-            case '1':   // tomato seeds
-                gt = GroundType::Seeds;
-                ct = CropType::Tomato;
-                break;
-            case '2':   // corn seeds
-                gt = GroundType::Seeds;
-                ct = CropType::Corn;
-                break;
-            case '3':   // potato seeds
-                gt = GroundType::Seeds;
-                ct = CropType::Potato;
-                break;
-            case '4':   // carrot seeds
-                gt = GroundType::Seeds;
-                ct = CropType::Carrot;
-                break;
-            case '5':   // lettuce seeds
-                gt = GroundType::Seeds;
-                ct = CropType::Lettuce;
-                break;
-
-    case 'G': 
-         gt = GroundType::Seeds;
-        break;
-    case 'E': 
-        gt = GroundType::Water;
-        break;
-    case 'S': 
-        gt = GroundType::Sun;
-        break;
-    case 'M': 
-        gt = GroundType::Market;
-        break;
-    case 'P': 
-        gt = GroundType::Trash;
-        break;
-    case 'F': 
-        gt = GroundType::Empty;
-        break;
-    default :  
-        gt = GroundType::Empty;
-        break;
-    }
-}
-
-// Helper to get crop name as string
-static const char* cropName(CropType c) {
-    switch (c) {
-    case CropType::Carrot:  return "Carrot";
-    case CropType::Tomato:  return "Tomato";
-    case CropType::Lettuce: return "Lettuce";
-    case CropType::Corn:    return "Corn";
-    case CropType::Potato:  return "Potato";
-    case CropType::None:
+// Fill colour of a tile, from its ground type and what grows on it
+static sf::Color tileColor(GroundType type, TileState state, bool levelLoaded) {
+    if (!levelLoaded) return sf::Color(90, 60, 30); // brown soil colour
+
+    switch (type) {
+    case GroundType::Soil:
+        if (state == TileState::Seeded || state == TileState::Watered || state == TileState::Suned)
+            return sf::Color(51, 25, 0);   // darker soil while something is planted
+        return sf::Color(102, 51, 0);      // dark soil
+    case GroundType::Seeds:  return sf::Color(255, 128, 0);   // orange
+    case GroundType::Water:  return sf::Color(153, 204, 255); // light blue
+    case GroundType::Sun:    return sf::Color(255, 255, 0);   // yellow
+    case GroundType::Market: return sf::Color(51, 102, 0);    // dark green
+    case GroundType::Trash:  return sf::Color(128, 128, 128); // grey
+    case GroundType::Wall:   return sf::Color(20, 20, 30);    // blocking wall
+    case GroundType::Empty:
     default:
-        return "None";
+        return sf::Color(40, 40, 60);      // floor
     }
 }
 
-// Convert a Request to a human-readable string
-std::string Game::requestToString(const Request& r) const {
-    if (r.items.empty())
-        return "No request";
-
-    std::string s;
-    for (size_t i = 0; i < r.items.size(); ++i) {
-        CropType ct = r.items[i].first;
-        int qty = r.items[i].second;
-        if (qty <= 0) continue;  // already fulfilled
-
-        if (!s.empty())
-            s += "  |  ";
-
-        s += std::to_string(qty);
-        s += "x ";
-        s += cropName(ct);
-    }
-    if (s.empty())
-        s = "Completed";
-    return s;
+// Sim position -> screen position
+sf::Vector2f Game::toScreen(const sf::Vector2f& p) const {
+    return { gridOrigin.x + p.x * simScale.x, gridOrigin.y + p.y * simScale.y };
 }
 
-
-
-// Global RNG for the game file
-static std::mt19937 rng{ std::random_device{}() };
-
-// Which crops are allowed per level
-std::vector<CropType> Game::allowedCropsForLevel(int level) const {
-    switch (level) {
-        case 1:  // level 1 : T, P, Ca
-            return { CropType::Tomato, CropType::Potato, CropType::Carrot };
-        case 2:  // level 2 : T, P, Ca, L
-            return { CropType::Tomato, CropType::Potato, CropType::Carrot, CropType::Lettuce };
-        case 3:  // level 3 : T, P, Ca, L, Co
-        case 4:  // level 4 : same variety, harder numbers
-        default:
-            return { CropType::Tomato, CropType::Potato, CropType::Carrot,
-                     CropType::Lettuce, CropType::Corn };
-    }
+sf::FloatRect Game::tileScreenRect(int index) const {
+    int cols = sim.getGridCols();
+    // each tile is slightly smaller than its "slot" so you see a small grid line between them
+    // (skipped once tiles get only a few pixels wide)
+    float gap = (tileScreenSize.x > 6.f && tileScreenSize.y > 6.f) ? 1.f : 0.f;
+    return sf::FloatRect(
+        gridOrigin.x + (index % cols) * tileScreenSize.x + gap,
+        gridOrigin.y + (index / cols) * tileScreenSize.y + gap,
+        tileScreenSize.x - 2.f * gap,
+        tileScreenSize.y - 2.f * gap);
 }
 
-// Max quantity per vegetable type, per level
-int Game::maxQtyForLevel(int level) const {
-    switch (level) {
-        case 1: return 3;  // from your examples
-        case 2: return 3;
-        case 3: return 4;
-        case 4: return 5;
-        default: return 5;
-    }
+void Game::colorTileQuad(int index, TileState state) {
+    sf::Color c = tileColor(sim.getGrid().type[index], state, sim.isLevelLoaded());
+    sf::Vertex* quad = &tileQuads[index * 4];
+    for (int k = 0; k < 4; ++k) quad[k].color = c;
+    shownTileStates[index] = state;
 }
 
-// How many requests per level
-int Game::numRequestsForLevel(int level) const {
-    switch (level) {
-        case 1: return 5;
-        case 2: return 7;
-        case 3: return 9;
-        case 4: return 12;
-        default: return 5;
-    }
+sf::Vector2f Game::interpolatedScreenPos(const sf::Vector2f& prev, const sf::Vector2f& pos) const {
+    // how far we are into the next (not yet simulated) step
+    float alpha = std::min(1.f, accumulator / GameSim::fixedStep);
+    return toScreen(prev + (pos - prev) * alpha);
 }
 
-// Generate one random request respecting all your rules
-Request Game::makeRandomRequest(int level) {
-    Request r;
-
-    auto allowed = allowedCropsForLevel(level);
-    int maxQty   = maxQtyForLevel(level);
-
-    if (allowed.empty()) return r;
-
-    //decide how many different vegetables (1..3, but not more than allowed.size())
-    int maxTypes = static_cast<int>(std::min<size_t>(3, allowed.size()));
-    std::uniform_int_distribution<int> distTypes(1, maxTypes);
-    int k = distTypes(rng);   // number of different crops in this request
-
-    //choose k distinct crops: shuffle then take first k
-    std::shuffle(allowed.begin(), allowed.end(), rng);
-
-    //for each chosen crop, choose a quantity 1..maxQty
-    std::uniform_int_distribution<int> distQty(1, maxQty);
-
-    for (int i = 0; i < k; ++i) {
-        CropType ct = allowed[i];
-        int qty = distQty(rng);
-        r.items.push_back({ct, qty});
-        r.initialQty.push_back(qty);
-        r.playerContrib.push_back(0);
-        r.aiContrib.push_back(0);
+void Game::placeAISprites(bool interpolate) {
+    const AIAgents& agents = sim.getAgents();
+    aiScreenPositions.resize(agents.size());
+    for (int a = 0; a < agents.size(); ++a) {
+        aiScreenPositions[a] = interpolate ? interpolatedScreenPos(agents.prevPosition[a], agents.position[a])
+                                           : toScreen(agents.position[a]);
     }
-
-    return r;
 }
 
 static void centerSpriteOrigin(sf::Sprite& s) {
@@ -313,20 +65,25 @@ static void centerSpriteOrigin(sf::Sprite& s) {
     s.setOrigin(bounds.width / 2.f, bounds.height / 2.f);
 }
 
-float Game::initialTimeForLevel(int level) const
-{
-    switch (level) {
-        case 1:  return 80.f;  // 1m20
-        case 2:  return 120.f;  // 2m
-        case 3:  return 140.f;  // 2m20
-        case 4:  return 180.f; // 3m
-        default: return 80.f;
-    }
+bool Game::debugKeys = false;
+
+// Game constructor 
+Game::Game(sf::RenderWindow& win, int levelID) : Game(win, levelID, GameSim::randomSeed(), nullptr) {
+}
+
+Game::Game(sf::RenderWindow& win, ReplayPlayer& replay) : Game(win, replay.getLevelID(), replay.getSeed(), &replay) {
 }
 
+Game::Game(sf::RenderWindow& win, int levelID, std::uint32_t seed, ReplayPlayer* replayPlayer)
+    : window(win), sim(levelID, seed), rewind(sim, RewindBuffer::defaultSeconds), replay(replayPlayer) {
 
-// Game constructor 
-Game::Game(sf::RenderWindow& win, int levelID) : window(win), levelID(levelID) {
+    // per-agent AI work goes to the shared worker pool
+    sim.setJobSystem(&JobSystem::instance());
+
+    // Record the match so it can be replayed exactly
+    if (!replay && !recorder.open(lastReplayPath, sim)) {
+        std::cerr << "[WARN] Could not record the match to " << lastReplayPath << "\n";
+    }
 
     // Font
     hasFont = font.loadFromFile("res/fonts/Inter-Regular.ttf");
@@ -430,133 +187,12 @@ Game::Game(sf::RenderWindow& win, int levelID) : window(win), levelID(levelID) {
         );
     }
 
-    // Playable area is everything below the top bar and
-
-    // bottom of the info board
-    float playTop = board.box.getPosition().y + board.box.getSize().y;
-    float playLeft = 0.f;
-    float playRight = winW;
-    float playBottom = winH;
-
-    float playWidth  = playRight - playLeft;
-    float playHeight = playBottom - playTop;
-
-    
-    // Grid size
-  
-
-    // Each tile will be a rectangle; we compute its size from the playable area
-    float tileWidth  = playWidth  / gridCols;
-    float tileHeight = playHeight / gridRows;
-
-    // we store a "generic" tileSize for later if you need it (useful e.g. for movement)
-    tileSize = std::min(tileWidth, tileHeight);
-
-    // top-left of the grid
-    gridOrigin = { playLeft, playTop };
-
-    
-    // Create brown soil tiles for the farm grid
-    
-    farm.clear();
-    farm.resize(gridRows * gridCols);
-
-    for (int row = 0; row < gridRows; ++row) {
-        for (int col = 0; col < gridCols; ++col) {
-
-            int idx = row * gridCols + col;
-            FarmTile& t = farm[idx];
-
-            // each tile is slightly smaller than its "slot"
-            // so you see a small grid line between them
-            t.rect.setSize({tileWidth - 2.f, tileHeight - 2.f});
-            t.rect.setPosition({
-                gridOrigin.x + col * tileWidth + 1.f,
-                gridOrigin.y + row * tileHeight + 1.f
-            });
-
-            t.type = GroundType::Empty; // will become Soil later
-            t.walkable = true; // player can walk on all ground
-            t.state = TileState::Empty; // nothing planted yet
-            t.growthTimer = 0.f;
-            t.rect.setFillColor(sf::Color(90, 60, 30)); // brown soil colour
-        }
-    }
-
-    
-    // Load level from file
-    std::string levelPath = "res/levels/level" + std::to_string(levelID) + ".txt";
-
-    centerPath.setSize({4.f, playHeight});
-    centerPath.setPosition(winW / 2.f - 2.f, playTop);
-    centerPath.setFillColor(sf::Color(255, 0, 0)); // red line
-    
-    std::ifstream in(levelPath);
-    if (!in) {
-        std::cerr << "[ERROR] Cannot open level file: " << levelPath << "\n";
-        // fall back: keep default GroundType::Empty for all tiles
-    } else {
-        std::vector<std::string> lines;
-        std::string line;
-        while (std::getline(in, line)) {
-            if (!line.empty() && line.back() == '\r') // Windows line endings
-                line.pop_back();
-            if ((int)line.size() >= gridCols)
-                lines.push_back(line.substr(0, gridCols));
-        }
-
-        if ((int)lines.size() < gridRows) {
-            std::cerr << "[WARN] Level file has fewer than " << gridRows << " rows\n";
-        } else {
-            for (int row = 0; row < gridRows; ++row) {
-                for (int col = 0; col < gridCols; ++col) {
-                    int idx = row * gridCols + col;
-                    FarmTile& t = farm[idx];
-
-                    char c = lines[row][col];
-                    GroundType gt;
-                    CropType ct;
-                    charToGroundType(c, gt, ct);
-
-                    t.type = gt;
-                    t.crop = ct;
-
-                    // choose color based on type
-                    switch (gt) {
-                    case GroundType::Soil:
-                        t.rect.setFillColor(sf::Color(102, 51, 0));       // dark soil
-                        t.walkable = true;
-                        break;
-                    case GroundType::Seeds:
-                        t.rect.setFillColor(sf::Color(255, 128, 0));      // orange
-                        t.walkable = true;
-                        break;
-                    case GroundType::Water:
-                        t.rect.setFillColor(sf::Color(153, 204, 255));    // light blue
-                        t.walkable = true;
-                        break;
-                    case GroundType::Sun:
-                        t.rect.setFillColor(sf::Color(255, 255, 0));      // yellow
-                        t.walkable = true;
-                        break;
-                    case GroundType::Market:
-                        t.rect.setFillColor(sf::Color(51, 102, 0));       // dark green
-                        t.walkable = true;
-                        break;
-                    case GroundType::Trash:
-                        t.rect.setFillColor(sf::Color(128, 128, 128));       // grey
-                        t.walkable = true;
-                        break;
-                    case GroundType::Empty:
-                    default:
-                        t.rect.setFillColor(sf::Color(40, 40, 60));       // floor
-                        t.walkable = true; // or false if you want
-                        break;
-                    }
-                }
-            }
-        }
-    }
+    // Farm tiles and everything placed relative to the play area
+    tileQuads.setPrimitiveType(sf::Quads);
+    tileQuads.resize(sim.getGrid().size() * 4);
+    shownTileStates.resize(sim.getGrid().size());
+    for (int i = 0; i < cropTextureCount; ++i) cropQuads[i].setPrimitiveType(sf::Quads);
+    recomputeLayout();
 
     tomatoTexture.loadFromFile("res/crops/tomato.png");
     cornTexture.loadFromFile("res/crops/corn.png"); 
@@ -564,112 +200,70 @@ Game::Game(sf::RenderWindow& win, int levelID) : window(win), levelID(levelID) {
     lettuceTexture.loadFromFile("res/crops/lettuce.png");
     potatoTexture.loadFromFile("res/crops/potato.png");
 
-    gameTimer = initialTimeForLevel(levelID);
-
-   //Farmer positions and appearance
-
-    sf::Vector2f playerStart(
-        winW * 0.25f,                         // quarter of the screen width
-        playTop + playHeight * 0.5f           // vertical center of the playable area
-    );
+   //Farmer appearance
 
-    // Player farmer
-    playerFarmer.body.setRadius(18.f);
-    playerFarmer.body.setOrigin(18.f, 18.f);
-    playerFarmer.body.setFillColor(gAppearance.playerColor);
-    playerFarmer.body.setPosition(playerStart);
-    playerFarmer.score = 0;
-
-playerFarmer.sprite.setTexture(
+playerSprite.setTexture(
     PlayerSpriteLibrary::instance().getTexture(gAppearance.playerTextureIndex)
 );
 
 // Use the whole texture (single-frame sprite)
-auto texSize = playerFarmer.sprite.getTexture()->getSize();
-playerFarmer.sprite.setTextureRect(sf::IntRect(
+auto texSize = playerSprite.getTexture()->getSize();
+playerSprite.setTextureRect(sf::IntRect(
     0, 0,
     static_cast<int>(texSize.x),
     static_cast<int>(texSize.y)
 ));
 
 // Center + scale like the AI
-centerSpriteOrigin(playerFarmer.sprite);
+centerSpriteOrigin(playerSprite);
 
-// Desired on-screen height relative to the circle body
-float desiredDisplayHeight = playerFarmer.body.getRadius() * 5.0f; // tweak 5.0f if you want bigger/smaller
+// Desired on-screen height relative to the farmer's body radius
+float desiredDisplayHeight = sim.getPlayer().radius * 5.0f; // tweak 5.0f if you want bigger/smaller
 
 float scaleFactor = 1.0f;
 if (texSize.y > 0)
     scaleFactor = desiredDisplayHeight / static_cast<float>(texSize.y);
 
-    playerFarmer.sprite.setScale(scaleFactor, scaleFactor);
-    centerSpriteOrigin(playerFarmer.sprite);
-    playerFarmer.sprite.setPosition(playerFarmer.body.getPosition());
-
+    playerSpriteScale = scaleFactor;
+    playerSprite.setScale(scaleFactor, scaleFactor);
+    centerSpriteOrigin(playerSprite);
+    playerSprite.setPosition(toScreen(sim.getPlayer().position));
 
-        // AI farmer
-        sf::Vector2f aiStart(winW * 0.75f, playTop + playHeight * 0.5f);  // three quarters of the screen width
-        aiFarmer.body.setRadius(18.f);
-        aiFarmer.body.setOrigin(18.f, 18.f);
-        aiFarmer.body.setFillColor(gAppearance.aiColor); 
-        aiFarmer.body.setPosition(aiStart);
-        aiFarmer.score = 0;
 
         // Use the dedicated AI texture from the PlayerSpriteLibrary when available.
         if (PlayerSpriteLibrary::instance().hasAiTexture()) {
-            aiFarmer.sprite.setTexture(PlayerSpriteLibrary::instance().getAiTexture());
+            aiSprite.setTexture(PlayerSpriteLibrary::instance().getAiTexture());
         } else {
             // Fallback to a player texture if AI texture missing (avoid crash)
-            aiFarmer.sprite.setTexture(PlayerSpriteLibrary::instance().getTexture(
+            aiSprite.setTexture(PlayerSpriteLibrary::instance().getTexture(
                 std::max(0, std::min(gAppearance.aiTextureIndex, PlayerSpriteLibrary::instance().getCount() - 1))
             ));
         }
     // --- AI uses a single full-frame sprite ---
     // Use the whole texture
-    auto texSizeAI = aiFarmer.sprite.getTexture()->getSize();
-    aiFarmer.sprite.setTextureRect(sf::IntRect(0, 0, texSizeAI.x, texSizeAI.y));
+    auto texSizeAI = aiSprite.getTexture()->getSize();
+    aiSprite.setTextureRect(sf::IntRect(0, 0, texSizeAI.x, texSizeAI.y));
 
     // Center origin
-    centerSpriteOrigin(aiFarmer.sprite);
+    centerSpriteOrigin(aiSprite);
 
     // Match AI height to the player's displayed height
-    float playerHeight = playerFarmer.sprite.getGlobalBounds().height;
+    float playerHeight = playerSprite.getGlobalBounds().height;
     float aiScale = 1.f;
     if (texSizeAI.y > 0)
         aiScale = playerHeight / static_cast<float>(texSizeAI.y);
 
-    aiFarmer.sprite.setScale(aiScale, aiScale);
-    centerSpriteOrigin(aiFarmer.sprite);
-    aiFarmer.sprite.setPosition(aiFarmer.body.getPosition());
-
-    // Generate requests for this level
-    int nReq = numRequestsForLevel(levelID);
-    requests.clear();
-    requests.reserve(nReq);
-
-    for (int i = 0; i < nReq; ++i) {
-        Request r = makeRandomRequest(levelID);
-        requests.push_back(r);
-    }
-
-    currentRequestIndex = 0;
-
-    // Debug: print them in console so you can see them
-    std::cout << "=== Requests for level " << levelID << " ===\n";
-    for (int i = 0; i < static_cast<int>(requests.size()); ++i) {
-        std::cout << "Request " << i + 1 << ": ";
-
-        for (const auto& item : requests[i].items) {
-            CropType ct = item.first;
-            int qty     = item.second;
-            std::cout << qty << "x " << cropName(ct) << "  ";
-        }
+    aiSpriteScale = aiScale;
+    aiSprite.setScale(aiScale, aiScale);
+    centerSpriteOrigin(aiSprite);
+    placeAISprites(false);
 
-        std::cout << "\n";
-    }
+    // sprites follow the zoom of the grid
+    recomputeLayout();
 
-    if (!requests.empty() && hasFont) {
+    if (sim.getOrders().getOpenCount() > 0 && hasFont) {
         updateCurrentRequestText();
+        syncHud();
     }
 }
 
@@ -711,7 +305,7 @@ void Game::recomputeLayout() {
         currentRequestText.setPosition(board.box.getPosition().x + 170.f, board.box.getPosition().y + 0.5f);
     }
 
-    // Playable area
+    // Playable area is everything below the bottom of the info board
     float playTop = board.box.getPosition().y + board.box.getSize().y;
     float playLeft = 0.f;
     float playRight = winW;
@@ -720,37 +314,40 @@ void Game::recomputeLayout() {
     float playWidth = playRight - playLeft;
     float playHeight = playBottom - playTop;
 
-    farmBounds = sf::FloatRect(gridOrigin.x, gridOrigin.y, playWidth, playHeight);
-
-    float tileWidth = playWidth / gridCols;
-    float tileHeight = playHeight / gridRows;
-
-    tileSize = std::min(tileWidth, tileHeight);
     gridOrigin = { playLeft, playTop };
+    farmBounds = sf::FloatRect(gridOrigin.x, gridOrigin.y, playWidth, playHeight);
 
-    // Update each tile
-    for (int row = 0; row < gridRows; ++row) {
-        for (int col = 0; col < gridCols; ++col) {
-            int idx = row * gridCols + col;
-            if (idx < 0 || idx >= static_cast<int>(farm.size())) continue;
-            FarmTile& t = farm[idx];
-            t.rect.setSize({tileWidth - 2.f, tileHeight - 2.f});
-            t.rect.setPosition({
-                gridOrigin.x + col * tileWidth + 1.f,
-                gridOrigin.y + row * tileHeight + 1.f
-            });
-        }
-    }
-
-    centerPath.setSize({4.f, playHeight});
-    centerPath.setPosition(winW / 2.f - 2.f, playTop);
-
-    // Reposition farmers to roughly the same relative spots
-    playerFarmer.body.setPosition(winW * 0.25f, playTop + playHeight * 0.5f);
-    playerFarmer.sprite.setPosition(playerFarmer.body.getPosition());
-
-    aiFarmer.body.setPosition(winW * 0.75f, playTop + playHeight * 0.5f);
-    aiFarmer.sprite.setPosition(aiFarmer.body.getPosition());
+    // the sim play area is stretched over the playable part of the window
+    const GridLayout& layout = sim.getLayout();
+    simScale = { playWidth / layout.playWidth, playHeight / layout.playHeight };
+
+    // Tile size on screen, from the sim's cached tile extent
+    tileScreenSize = { layout.tileSize.x * simScale.x, layout.tileSize.y * simScale.y };
+    tileSize = std::min(tileScreenSize.x, tileScreenSize.y);
+
+    // Rebuild every tile quad
+    const int tileCount = sim.getGrid().size();
+    for (int idx = 0; idx < tileCount && idx * 4 < static_cast<int>(tileQuads.getVertexCount()); ++idx) {
+        sf::FloatRect r = tileScreenRect(idx);
+        sf::Vertex* quad = &tileQuads[idx * 4];
+        quad[0].position = { r.left, r.top };
+        quad[1].position = { r.left + r.width, r.top };
+        quad[2].position = { r.left + r.width, r.top + r.height };
+        quad[3].position = { r.left, r.top + r.height };
+        colorTileQuad(idx, sim.tileState(idx));
+    }
+
+    // Divider between the two sides (red line, never thinner than 2px)
+    centerPath.setSize({std::max(2.f, (sim.getWallRight() - sim.getWallLeft()) * simScale.x), playHeight});
+    centerPath.setPosition(toScreen({sim.getWallLeft(), 0.f}));
+    centerPath.setFillColor(sf::Color(255, 0, 0));
+
+    // Farmers keep their place in the sim, only the sprites move and scale
+    float zoom = std::min(simScale.x, simScale.y);
+    playerSprite.setScale(playerSpriteScale * zoom, playerSpriteScale * zoom);
+    aiSprite.setScale(aiSpriteScale * zoom, aiSpriteScale * zoom);
+    playerSprite.setPosition(toScreen(sim.getPlayer().position));
+    placeAISprites(false);
 }
 
 void Game::showTextPopup(const sf::Font& font, const std::string& msg, sf::Vector2f position) {
@@ -782,22 +379,36 @@ void Game::updateCurrentRequestText()
 {
     if (!hasFont) return;
 
-    if (currentRequestIndex >= 0 &&
-        currentRequestIndex < static_cast<int>(requests.size()))
+    const OrderBook& orders = sim.getOrders();
+    const Request* current = orders.getOldestOpen();
+
+    if (current)
     {
-        const Request& r = requests[currentRequestIndex];
+        const Request& r = *current;
 
-        std::string label = "Request " +
-            std::to_string(currentRequestIndex + 1) + "/" +
-            std::to_string(static_cast<int>(requests.size())) + ": ";
+        std::string label = "Request " + std::to_string(r.id + 1);
+        if (!orders.isEndless()) label += "/" + std::to_string(orders.getTotal());
+        label += ": ";
+        std::string more;
+        if (orders.getOpenCount() > 1) more = "  (+" + std::to_string(orders.getOpenCount() - 1) + " open)";
 
-        currentRequestText.setString(label + requestToString(r));
+        currentRequestText.setString(label + sim.requestToString(r) + more);
     }
     else {
         currentRequestText.setString("All requests completed!");
     }
 }
 
+// Bring the HUD counters in line with the sim
+void Game::syncHud()
+{
+    if (hasFont) {
+        timerText.setString(std::to_string(static_cast<int>(sim.getTimeLeft())) + "s");
+        playerScoreText.setString("You: " + std::to_string(sim.getPlayerScore()) + "  Req: " + std::to_string(sim.getPlayerRequestsCompleted()));
+        aiScoreText.setString("AI: " + std::to_string(sim.getAIScore()) + "  Req: " + std::to_string(sim.getAIRequestsCompleted()));
+    }
+}
+
 void Game::handleEvent(const sf::Event& e) {
     if (e.type == sf::Event::MouseButtonPressed && e.mouseButton.button == sf::Mouse::Left) {
         sf::Vector2f m{(float)e.mouseButton.x, (float)e.mouseButton.y};
@@ -813,7 +424,7 @@ void Game::handleEvent(const sf::Event& e) {
         window.close(); //quit app
     }
 
-    if (!PauseGame && !Tutorial && !EndGame && e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::Space) {
+    if (!PauseGame && !Tutorial && !sim.isGameOver() && e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::Space) {
         PauseGame = true; 
         return;
     }
@@ -840,7 +451,7 @@ void Game::handleEvent(const sf::Event& e) {
         return; // while popup is open, ignore other events
     }
 
-    if (EndGame) {
+    if (sim.isGameOver()) {
         if (e.type == sf::Event::KeyPressed) {
             if (e.key.code == sf::Keyboard::P) {
               action = GameAction::Play;   // play again
@@ -850,7 +461,7 @@ void Game::handleEvent(const sf::Event& e) {
             }
             else if (e.key.code == sf::Keyboard::N) {
                 // Next level only available from level 1 when player won
-                if (levelID == 1 && winner == Winner::Player) {
+                if (sim.getLevelID() == 1 && sim.getWinner() == Winner::Player) {
                     action = GameAction::Next;
                 }
             }
@@ -858,224 +469,43 @@ void Game::handleEvent(const sf::Event& e) {
         return; // while popup is open, ignore other events
     }
 
-    if (!PauseGame && e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::T) { //T = take
+    if (replay) return; // a replay ignores the keyboard
 
-        // Player interacts with the tile under them
-        sf::Vector2f p = playerFarmer.body.getPosition();
-
-        for (auto& tile : farm) { 
-            if (!tile.rect.getGlobalBounds().contains(p)) continue; 
-                if (tile.type == GroundType::Seeds && !playerFarmer.hasSeed) {
-                    // take seed
-                    playerFarmer.carriedSeed = tile.crop;
-                    playerFarmer.hasSeed = true; 
-                    std::cout << "Player: " << cropName(tile.crop) << " seed taken\n";
-                    // trigger a small visual on the seed box to indicate it was taken
-                    tile.seedTakenTimer = seed_take_visual_temp;
-                    tile.seedTakenCrop = tile.crop;
-                    break;
-                }
-                if (tile.type == GroundType::Water && !playerFarmer.hasWater) {
-                    // take water
-                    playerFarmer.hasWater = true;
-                    std::cout << "Player: Water taken\n";   
-                    break;             
-                }
-                if (tile.type == GroundType::Sun && !playerFarmer.hasSun) {
-                    // take sun
-                    playerFarmer.hasSun = true;
-                    std::cout << "Player: Sun taken\n";
-                    break;
-                }
-                if (tile.state == TileState::Grown && tile.type == GroundType::Soil) {
-                    // harvest
-                    tile.state = TileState::Empty;
-                    playerFarmer.carriedSeed = tile.crop;
-                    tile.growthTimer = 0.f;
-                    tile.rect.setFillColor(sf::Color(102, 51, 0)); // back to soil
-                    playerFarmer.hasProduct = true;
-                    std::cout << "Player: " << cropName(tile.crop) << " harvested\n";
-                    break;
-                } 
-                break;
-        }
+    if (debugKeys && e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::BackSpace) {
+        rewindMatch(rewindStepBack);
+        return;
     }
 
-    if (!PauseGame && e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::D) { //D = drop
-
-        // Player interacts with the tile under them
-        sf::Vector2f p = playerFarmer.body.getPosition();
-
-        for (auto& tile : farm) { 
-            if (!tile.rect.getGlobalBounds().contains(p)) continue; 
-
-                if (tile.state == TileState::Empty && tile.type == GroundType::Soil && playerFarmer.hasSeed) {
-                    // plant seed
-                    tile.state = TileState::Seeded;
-                    tile.growthTimer = 0.f;
-                    tile.crop = playerFarmer.carriedSeed;
-                    playerFarmer.hasSeed = false;   
-                    playerFarmer.carriedSeed = CropType::None;
-                    std::cout << "Player: " << cropName(tile.crop) << " seed planted\n";
-                    tile.rect.setFillColor(sf::Color(51, 25, 0)); // darker soil
-                    break;
-                }
-                if (tile.state == TileState::Seeded && tile.type == GroundType::Soil && playerFarmer.hasWater) {
-                    // drop water
-                    tile.state = TileState::Watered;
-                    tile.growthTimer = 0.f;
-                    playerFarmer.hasWater = false;
-                    std::cout << "Player: " << cropName(tile.crop) << " plant watered\n";
-                    break;
-                }
-                if (tile.state == TileState::Seeded && tile.type == GroundType::Soil && playerFarmer.hasSun) {
-                    // drop sun
-                    tile.state = TileState::Suned;
-                    tile.growthTimer = 0.f;
-                    std::cout << "Player: Sun dropped\n";
-                    playerFarmer.hasSun = false;
-                    break;
-                } 
-                if (tile.type == GroundType::Market && playerFarmer.hasProduct) {
-                    // sell product
-                    CropType product = playerFarmer.carriedSeed;
-
-                    if(currentRequestIndex >= 0 && currentRequestIndex < static_cast<int>(requests.size())) {
-                        Request& r = requests[currentRequestIndex];
-                        bool completed = false;
-                        // find the matching item index and attribute this sale to the player
-                        for (size_t i = 0; i < r.items.size(); ++i) {
-                            auto &item = r.items[i];
-                            if (item.first == product && item.second > 0) {
-                                item.second -= 1; // decrease quantity needed
-                                r.playerContrib[i] += 1; // attribute to player
-                                completed = true;
-                                playerFarmer.score += 5; // give 5 points per required veg delivered
-                                playerCorrectDeliveries += 1; // count correct deliveries
-                                std::cout << "Player score +5\n";
-                                std::cout << "Player score: " << playerFarmer.score << "\n";
-                                break;
-                            }
-                        }
-
-                        if (completed) {
-                            std::cout << "Player delivered " << cropName(product) << " for the request \n";
-                                    // trigger a short "sold" visual on this market tile
-                                    tile.soldTimer = sold_visual_temp;
-                                    tile.soldCrop = product;
-                                    updateCurrentRequestText();
-
-
-                            // Check if the entire request is fulfilled
-                            bool allDone = true;
-                            for (const auto& item : r.items) {
-                                if (item.second > 0) { allDone = false; break; }
-                            }
-
-                            if (allDone) {
-                                // Ensure completion is only processed once
-                                if (!r.completed) {
-                                    // determine total initial qty
-                                    int totalQty = 0;
-                                    for (size_t i = 0; i < r.items.size(); ++i) totalQty += r.initialQty[i];
-                                    // compute how many items each side delivered for this request
-                                    int playerDelivered = 0;
-                                    int aiDelivered = 0;
-                                    for (size_t j = 0; j < r.playerContrib.size(); ++j) playerDelivered += r.playerContrib[j];
-                                    for (size_t j = 0; j < r.aiContrib.size(); ++j) aiDelivered += r.aiContrib[j];
-                                    int N = totalQty;
-
-                                    if (playerDelivered > aiDelivered) {
-                                        playerRequestsCompleted += 1; // dominated count
-                                        playerFarmer.score += 3 * N;  // full bonus to player
-                                        std::cout << "Player completion bonus +" << 3 * N << "\n";
-                                    } else if (aiDelivered > playerDelivered) {
-                                        aiRequestsCompleted += 1;
-                                        aiFarmer.score += 3 * N;
-                                        std::cout << "AI completion bonus +" << 3 * N << "\n";
-                                    } else {
-                                        // tie: split the 3*N bonus evenly (round to nearest)
-                                        int tieBonus = static_cast<int>(std::round((3.0 * N) / 2.0));
-                                        playerRequestsCompleted += 1;
-                                        aiRequestsCompleted += 1;
-                                        playerFarmer.score += tieBonus;
-                                        aiFarmer.score += tieBonus;
-                                        std::cout << "Tie completion bonus +" << tieBonus << " each\n";
-                                    }
-
-                                    r.completed = true; // mark so we don't double-award
-                                    std::cout << "[DBG] Request " << (currentRequestIndex + 1) << " N=" << N << " playerDelivered=" << playerDelivered << " aiDelivered=" << aiDelivered << "\n";
-                                }
-
-                                showTextPopup(font, "Request " + std::to_string(currentRequestIndex + 1) + " completed!\n", {300.f, 50.f});
-                                std::cout << "Request " << (currentRequestIndex + 1) << " completed!\n";
-                                currentRequestIndex++;
-                                if (currentRequestIndex < static_cast<int>(requests.size()) && hasFont) {
-                                    currentRequestText.setString("Request: " + requestToString(requests[currentRequestIndex]));
-                                } else {
-                                    currentRequestText.setString("All requests completed!");
-                                    EndGame = true;
-                                    decideWinnerOnGameEnd();
-                                }
-                                updateCurrentRequestText();
-
-                                // Other player completed the request — make AI abandon its current task
-                                // so it immediately re-evaluates the new request (or picks a new target).
-                                aiPath.clear();
-                                aiPathIndex = 0;
-                                aiTargetCrop = CropType::None;
-                                aiState = AIState::SelectGoal;
-                            }
-                        } else {
-                            std::cout << "Player: " << cropName(product) << " is not needed for the current request\n";
-                        }
-                    }
+    // Take / drop are queued and happen at the start of the next sim step
+    if (!PauseGame && e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::T) { //T = take
+        pendingInput.take = true;
+    }
 
-                    playerFarmer.hasProduct = false;
-                    playerFarmer.carriedSeed = CropType::None;
-                    break;
-                }
-                if (tile.type == GroundType::Trash) {
-                    if (playerFarmer.hasSeed) {
-                        playerFarmer.hasSeed = false;
-                        std::cout << "Player: " << cropName(playerFarmer.carriedSeed) << " seed discarded\n";
-                        playerFarmer.carriedSeed = CropType::None;
-                        break;
-                    }
-                    if (playerFarmer.hasWater) {
-                        playerFarmer.hasWater = false;
-                        std::cout << "Player: Water discarded\n";
-                        break;
-                    }
-                    if (playerFarmer.hasSun) {
-                        playerFarmer.hasSun = false;
-                        std::cout << "Player: Sun discarded\n";
-                        break;
-                    }
-                    if (playerFarmer.hasProduct) {
-                        playerFarmer.hasProduct = false;
-                        std::cout << "Player: " << cropName(playerFarmer.carriedSeed) << "  discarded\n";
-                        playerFarmer.carriedSeed = CropType::None;
-                        break;
-                    }
-                }
-        }
-    }  
+    if (!PauseGame && e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::D) { //D = drop
+        pendingInput.drop = true;
+    }
 }
 
-void Game::decideWinnerOnGameEnd()
-{
-    if (playerFarmer.score > aiFarmer.score) {
-        winner = Winner::Player;
-    } else if (aiFarmer.score > playerFarmer.score) {
-        winner = Winner::AI;
-    } else {
-        winner = Winner::Tie;
-    }
+// Put the match back a few seconds (as far as the rewind history goes)
+void Game::rewindMatch(float seconds) {
+    if (rewind.empty()) return;
+    std::uint32_t back = static_cast<std::uint32_t>(seconds / GameSim::fixedStep);
+    std::uint32_t from = sim.getTick();
+    std::uint32_t target = from > back ? from - back : 0;
+    target = std::max(target, rewind.getOldestTick());
+    if (!rewind.restore(sim, target)) return;
+    recorder.recordRewind(from, sim.getTick());
+
+    accumulator = 0.f;
+    pendingInput = PlayerInput();
+    playerSprite.setPosition(toScreen(sim.getPlayer().position));
+    placeAISprites(false);
+    updateCurrentRequestText();
+    syncHud();
 }
 
 void Game::update(float dt) {
-    if (PauseGame || EndGame) return; // don't update when game is paused
+    if (PauseGame || sim.isGameOver()) return; // don't update when game is paused
 
     // Player movement input
 
@@ -1084,538 +514,81 @@ void Game::update(float dt) {
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) v.x += 1.f;
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up))    v.y -= 1.f;
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down))  v.y += 1.f;
-
-    // normalise diagonal movement so speed is the same in all directions
-    if (v.x != 0.f || v.y != 0.f) {
-        float len = std::sqrt(v.x * v.x + v.y * v.y);
-        v /= len;
-    }
-
-    // Playable area is everything below the top bar and bottom of the info board
-
-    float playTop = board.box.getPosition().y + board.box.getSize().y;
-    float playLeft = 0.f;
-    float playRight = static_cast<float>(window.getSize().x);
-    float playBottom = static_cast<float>(window.getSize().y);
-
-    sf::FloatRect playArea(playLeft, playTop, playRight - playLeft, playBottom - playTop);
-
-    sf::FloatRect wall = centerPath.getGlobalBounds(); // wall between the two players
-    
-    // Move player farmer
-
-    if (v.x != 0.f || v.y != 0.f) {
-        sf::Vector2f next = playerFarmer.body.getPosition() + v * speed * dt;
-        playerFarmer.sprite.setPosition(playerFarmer.body.getPosition()); // keep sprite in sync
-        float r = playerFarmer.body.getRadius();
-    
-
-        // bounding box of the circle at the next position
-        sf::FloatRect circle(next.x - r, next.y - r, 2.f * r, 2.f * r);
-
-        // check all 4 corners: if they are inside playArea,
-        // then the whole circle is inside the playable zone
-        bool inside =
-            playArea.contains(circle.left, circle.top) &&
-            playArea.contains(circle.left + circle.width, circle.top) &&
-            playArea.contains(circle.left, circle.top + circle.height) &&
-            playArea.contains(circle.left + circle.width, circle.top + circle.height);
-        
-        bool leftOfWall = (next.x + r) <= wall.left; // must stay on the left side of the wall
-
-        if (inside && leftOfWall) {
-            playerFarmer.body.setPosition(next); 
-            playerFarmer.sprite.setPosition(playerFarmer.body.getPosition()); // keep sprite in sync
+    pendingInput.move = v;
+
+    // Run as many fixed steps as the elapsed time pays for
+    accumulator += dt;
+    int steps = 0;
+    while (accumulator >= GameSim::fixedStep && steps < maxStepsPerFrame && !sim.isGameOver()) {
+        if (replay) {
+            if (!replay->step(sim)) break;
+        } else {
+            recorder.recordStep(pendingInput, sim.getTick());
+            sim.step(pendingInput);
+            rewind.capture(sim);
         }
+        pendingInput.take = false;
+        pendingInput.drop = false;
+        accumulator -= GameSim::fixedStep;
+        steps++;
     }
-
-    // AI movement: simple left-right bouncing
-
-    static float aiDir = 1.f; // 1 = move right, -1 = move left
-
-    sf::Vector2f aiVel(aiDir, 0.f); // simple left-right movement
-    sf::Vector2f aiNext = aiFarmer.body.getPosition() + aiVel * (speed * 0.4f * dt);
-    aiFarmer.sprite.setPosition(aiFarmer.body.getPosition()); // keep sprite in sync
-    float ar = aiFarmer.body.getRadius();
-
-    sf::FloatRect aiCircle(aiNext.x - ar, aiNext.y - ar, 2.f * ar, 2.f * ar);
-
-    bool aiInside =
-        playArea.contains(aiCircle.left, aiCircle.top) &&
-        playArea.contains(aiCircle.left + aiCircle.width, aiCircle.top) &&
-        playArea.contains(aiCircle.left, aiCircle.top + aiCircle.height) &&
-        playArea.contains(aiCircle.left + aiCircle.width, aiCircle.top + aiCircle.height);
-
-    bool rightOfWall = (aiNext.x - ar) >= (wall.left + wall.width); // must stay on the right side of the wall
-
-    if (aiInside && rightOfWall) {
-        aiFarmer.body.setPosition(aiNext);
-        aiFarmer.sprite.setPosition(aiFarmer.body.getPosition()); // keep sprite in sync
-    } else {
-        aiDir *= -1.f; // if next position would leave the area, bounce
+    if (steps == maxStepsPerFrame && accumulator >= GameSim::fixedStep) {
+        accumulator = std::fmod(accumulator, GameSim::fixedStep); // too far behind: let the sim slow down
     }
 
-    // Rest of update (crops growing, timers, AI logic, etc.)
+    // keep sprites in sync with the sim (interpolated between the last two steps)
+    playerSprite.setPosition(interpolatedScreenPos(sim.getPlayer().prevPosition, sim.getPlayer().position));
+    placeAISprites(true);
 
-    // Grow crops
-    sf::Vector2f p = playerFarmer.body.getPosition();
-    for (auto& tile : farm) {
-        if (tile.type == GroundType::Soil && tile.state != TileState::Empty && tile.state != TileState::Grown) {
-            tile.growthTimer += dt;
-            if (tile.growthTimer > 3.f) { // 3 seconds to grow
-                tile.state = TileState::Grown;
-                tile.rect.setFillColor(sf::Color(102, 51, 0)); // back to brown soil colour 
-            }
-        }
-    }
+    if (sim.isGameOver()) recorder.close(sim.getTick());
 
-    // Update sold visual timers
-    for (auto& tile : farm) {
-        if (tile.soldTimer > 0.f) {
-            tile.soldTimer -= dt;
-            if (tile.soldTimer <= 0.f) {
-                tile.soldTimer = 0.f;
-                tile.soldCrop = CropType::None;
-            }
-        }
-        // update seed-taken timers as well
-        if (tile.seedTakenTimer > 0.f) {
-            tile.seedTakenTimer -= dt;
-            if (tile.seedTakenTimer <= 0.f) {
-                tile.seedTakenTimer = 0.f;
-                tile.seedTakenCrop = CropType::None;
-            }
-        }
-    }
+    handleSimEvents();
+    syncHud();
 
-    // update global timer
-    gameTimer -= dt;
-    if (gameTimer <= 0.f) {
-        gameTimer = 0.f;
-        if (!EndGame) {
-            EndGame = true;
-            // Determine winner with tiebreakers:
-            if (playerFarmer.score > aiFarmer.score) {
-                winner = Winner::Player;
-            } else if (aiFarmer.score > playerFarmer.score) {
-                winner = Winner::AI;
-            } else {
-                // tie on score -> compare number of requests dominated
-                if (playerRequestsCompleted > aiRequestsCompleted) winner = Winner::Player;
-                else if (aiRequestsCompleted > playerRequestsCompleted) winner = Winner::AI;
-                else {
-                    // still tie -> compare correct deliveries
-                    if (playerCorrectDeliveries > aiCorrectDeliveries) winner = Winner::Player;
-                    else if (aiCorrectDeliveries > playerCorrectDeliveries) winner = Winner::AI;
-                    else winner = Winner::Tie;
-                }
-            }
+    if (popup.active) {
+        popup.timer += dt;
+        if (popup.timer >= popup.duration) {
+            popup.active = false; // stop showing it
         }
-            // Save the player's score for this level (always overwrite).
-            if (!scoreSaved) {
-                int idx = levelID - 1;
-                if (idx < 0) idx = 0;
-                if ((int)PlayerSave::activePlayer.highScores.size() <= idx) {
-                    PlayerSave::activePlayer.highScores.resize(idx + 1, 0);
-                }
-                PlayerSave::activePlayer.highScores[idx] = playerFarmer.score;
-                PlayerSave::activePlayer.saveToFile();
-                scoreSaved = true;
-            }
     }
+}
 
-    if (hasFont) {
-        timerText.setString(std::to_string(static_cast<int>(gameTimer)) + "s");
-        playerScoreText.setString("You: " + std::to_string(playerFarmer.score) + "  Req: " + std::to_string(playerRequestsCompleted));
-        aiScoreText.setString("AI: " + std::to_string(aiFarmer.score) + "  Req: " + std::to_string(aiRequestsCompleted));
-    }
-
-    // AI state machine & path-following 
-    auto aiPos = aiFarmer.body.getPosition();
-
-    // Helper to set path to a tile index
-    auto setAIPathToTile = [&](int tileIdx){
-        int start = tileIndexFromPos(aiPos);
-        if (start < 0) {
-            // fallback: compute from current position -> approximate nearest tile
-            // pick the tile under ai
-            start = tileIndexFromPos(aiFarmer.body.getPosition());
-        }
-        aiPath = findPathAStar(start, tileIdx);
-        aiPathIndex = 0;
-
-        // If no path found (often because the goal is on the player's side),
-        // try a fallback: find the nearest suitable tile on the AI's right side
-        // and attempt to path to that instead.
-        if (aiPath.empty()) {
-            if (tileIdx < 0 || tileIdx >= static_cast<int>(farm.size())) return;
-
-            // compute right edge of divider
-            sf::FloatRect wall = centerPath.getGlobalBounds();
-            float wallRightX = wall.left + wall.width;
-
-            // determine what kind of tile we were trying to reach
-            GroundType targetType = farm[tileIdx].type;
-            CropType targetCrop = farm[tileIdx].crop;
-            TileState targetState = farm[tileIdx].state;
-
-            int bestCandidate = -1;
-            float bestDist = std::numeric_limits<float>::max();
-
-            for (int i = 0; i < static_cast<int>(farm.size()); ++i) {
-                // must be on the right side of the wall
-                sf::Vector2f tc = tileCenter(i);
-                if (tc.x <= wallRightX) continue;
-
-                // must be walkable
-                if (!isTileWalkable(i)) continue;
-
-                // match candidate to the original target semantics
-                bool match = false;
-                if (targetType == GroundType::Seeds) {
-                    match = (farm[i].type == GroundType::Seeds && farm[i].crop == targetCrop);
-                } else if (targetType == GroundType::Soil) {
-                    // prefer soil tiles that are empty (planting target)
-                    match = (farm[i].type == GroundType::Soil && farm[i].state == TileState::Empty);
-                } else if (targetType == GroundType::Market) {
-                    match = (farm[i].type == GroundType::Market);
-                } else {
-                    // generic fallback: allow any walkable tile on right side
-                    match = true;
-                }
-
-                if (!match) continue;
-
-                float d = std::hypot(tc.x - aiPos.x, tc.y - aiPos.y);
-                if (d < bestDist) {
-                    bestDist = d;
-                    bestCandidate = i;
-                }
-            }
-
-            if (bestCandidate >= 0) {
-                auto tryPath = findPathAStar(start, bestCandidate);
-                if (!tryPath.empty()) {
-                    aiPath = std::move(tryPath);
-                    aiPathIndex = 0;
-                }
-            }
-        }
-    };
-
-    auto moveAIAlongPath = [&](float dt)->bool {
-        if (aiPath.empty() || aiPathIndex >= static_cast<int>(aiPath.size())) return false;
-        sf::Vector2f target = tileCenter(aiPath[aiPathIndex]);
-        sf::Vector2f dir = target - aiPos;
-        float dist = std::sqrt(dir.x*dir.x + dir.y*dir.y);
-        if (dist < aiArriveThreshold) { // reached waypoint
-            aiPathIndex++;
-            return true;
-        }
-        // normalise and apply speed (seek)
-        dir /= dist;
-        sf::Vector2f vel = dir * (aiMaxSpeed * dt);
-        // move ai, but keep on right side of centerPath wall as before
-        sf::FloatRect wall = centerPath.getGlobalBounds();
-        float ar = aiFarmer.body.getRadius();
-        sf::Vector2f next = aiPos + vel;
-        sf::FloatRect aiCircle(next.x - ar, next.y - ar, 2*ar, 2*ar);
-        // ensure inside play area and right of wall (reuse your earlier checks)
-        float playTop = board.box.getPosition().y + board.box.getSize().y;
-        float playLeft = 0.f;
-        float playRight = static_cast<float>(window.getSize().x);
-        float playBottom = static_cast<float>(window.getSize().y);
-
-        sf::FloatRect playArea(playLeft, playTop, playRight - playLeft, playBottom - playTop);
-        bool aiInside =
-            playArea.contains(aiCircle.left, aiCircle.top) &&
-            playArea.contains(aiCircle.left + aiCircle.width, aiCircle.top) &&
-            playArea.contains(aiCircle.left, aiCircle.top + aiCircle.height) &&
-            playArea.contains(aiCircle.left + aiCircle.width, aiCircle.top + aiCircle.height);
-
-        bool rightOfWall = (next.x - ar) >= (wall.left + wall.width);
-
-        if (aiInside && rightOfWall) {
-            aiFarmer.body.setPosition(next);
-        } else {
-            // cannot move directly; clear path so next iteration recalculates
-            aiPath.clear();
-        }
-        return true;
-    };
-
-    // AI decision helper: choose a crop requested (highest remaining qty) or nearest seed if none
-    auto chooseTargetCrop = [&]()->CropType {
-        if (currentRequestIndex >= 0 && currentRequestIndex < static_cast<int>(requests.size())) {
-            Request& r = requests[currentRequestIndex];
-            // choose highest qty remaining
-            int bestQty = 0;
-            CropType best = CropType::None;
-            for (auto &it : r.items) {
-                if (it.second > bestQty) { bestQty = it.second; best = it.first; }
-            }
-            if (best != CropType::None) return best;
-        }
-        // fallback: pick first allowed crop that exists in seed boxes
-        for (int i = 0; i < static_cast<int>(farm.size()); ++i) {
-            if (farm[i].type == GroundType::Seeds && farm[i].crop != CropType::None) {
-                return farm[i].crop;
-            }
-        }
-        return CropType::None;
-    };
-
-    // State machine transitions & actions
-    switch (aiState) {
-        case AIState::SelectGoal: {
-            aiTargetCrop = chooseTargetCrop();
-            if (aiTargetCrop == CropType::None) {
-                aiState = AIState::Idle;
+void Game::handleSimEvents() {
+    bool requestChanged = false;
+    GameEvent e;
+    while (sim.getEvents().pop(e)) {
+        appendEventText(eventText, e);
+        switch (e.type) {
+            case GameEventType::Delivered:
+                requestChanged = requestChanged || e.playerPoints > 0 || e.aiPoints > 0;
                 break;
-            }
-            // find nearest seed tile for that crop
-            int bestIdx = -1; float bestDist = 1e9;
-            for (int i = 0; i < static_cast<int>(farm.size()); ++i) {
-                if (farm[i].type == GroundType::Seeds && farm[i].crop == aiTargetCrop) {
-                    float d = std::hypot(tileCenter(i).x - aiPos.x, tileCenter(i).y - aiPos.y);
-                    if (d < bestDist) { bestDist = d; bestIdx = i; }
-                }
-            }
-            if (bestIdx >= 0) {
-                setAIPathToTile(bestIdx);
-                aiState = AIState::GoToSeeds;
-            } else {
-                // no seeds available: idle for a moment
-                aiState = AIState::Idle;
-            }
-            break;
-        }
-
-        case AIState::GoToSeeds: {
-            if (aiPath.empty()) {
-                // recompute path to nearest seed tile
-                int targetIdx = -1; float bestDist = 1e9;
-                for (int i = 0; i < static_cast<int>(farm.size()); ++i) {
-                    if (farm[i].type == GroundType::Seeds && farm[i].crop == aiTargetCrop) {
-                        float d = std::hypot(tileCenter(i).x - aiPos.x, tileCenter(i).y - aiPos.y);
-                        if (d < bestDist) { bestDist = d; targetIdx = i; }
-                    }
-                }
-                if (targetIdx >= 0) setAIPathToTile(targetIdx);
-                else aiState = AIState::SelectGoal;
+            case GameEventType::RequestCompleted:
+                requestChanged = true;
+                // popup only for the requests the player finished themselves
+                if (e.farmer < 0) showTextPopup(font, "Request " + std::to_string(e.request + 1) + " completed!\n", {300.f, 50.f});
                 break;
-            }
-            // follow the path
-            moveAIAlongPath(dt);
-            // If close enough to final goal tile, simulate 'take seed' like player `T` does
-            if (aiPathIndex >= static_cast<int>(aiPath.size())) {
-                int finalTile = aiPath.empty() ? -1 : aiPath.back();
-                if (finalTile >= 0) {
-                    // perform take seed
-                    if (farm[finalTile].type == GroundType::Seeds && !aiFarmer.hasSeed && farm[finalTile].crop == aiTargetCrop) {
-                        aiFarmer.carriedSeed = farm[finalTile].crop;
-                        aiFarmer.hasSeed = true;
-                        // optionally: leave the seed box as is (multiple seeds) or mark as taken
-                        std::cout << "AI: took " << cropName(aiFarmer.carriedSeed) << " seed\n";
-                        // seed-taken visual for AI taking a seed
-                        farm[finalTile].seedTakenTimer = seed_take_visual_temp;
-                        farm[finalTile].seedTakenCrop = farm[finalTile].crop;
-                        aiState = AIState::GoToPlant;
-                        // Choose planting spot: nearest soil empty tile
-                        int plantIdx = -1; float bd = 1e9;
-                        for (int i = 0; i < static_cast<int>(farm.size()); ++i) {
-                            if (farm[i].type == GroundType::Soil && farm[i].state == TileState::Empty) {
-                                float d = std::hypot(tileCenter(i).x - aiPos.x, tileCenter(i).y - aiPos.y);
-                                if (d < bd) { bd = d; plantIdx = i; }
-                            }
-                        }
-                        if (plantIdx >= 0) setAIPathToTile(plantIdx);
-                        else aiState = AIState::Idle;
-                    } else {
-                        aiState = AIState::SelectGoal;
+            case GameEventType::MatchEnded:
+                // Save the player's score for this level (always overwrite) once the time is up.
+                if (!replay && sim.getTimeLeft() <= 0.f && !scoreSaved) {
+                    int idx = sim.getLevelID() - 1;
+                    if (idx < 0) idx = 0;
+                    if ((int)PlayerSave::activePlayer.highScores.size() <= idx) {
+                        PlayerSave::activePlayer.highScores.resize(idx + 1, 0);
                     }
-                } else {
-                    aiState = AIState::SelectGoal;
+                    PlayerSave::activePlayer.highScores[idx] = sim.getPlayerScore();
+                    PlayerSave::activePlayer.saveToFile();
+                    scoreSaved = true;
                 }
-            }
-            break;
-        }
-
-        case AIState::GoToPlant: {
-            if (aiPath.empty()) {
-                // no available planting tile: return to select
-                aiState = AIState::SelectGoal;
                 break;
-            }
-            moveAIAlongPath(dt);
-            if (aiPathIndex >= static_cast<int>(aiPath.size())) {
-                // arrived at tile: plant if possible
-                int finalTile = aiPath.empty() ? -1 : aiPath.back();
-                if (finalTile >= 0 && aiFarmer.hasSeed && farm[finalTile].type == GroundType::Soil && farm[finalTile].state == TileState::Empty) {
-                    farm[finalTile].state = TileState::Seeded;
-                    farm[finalTile].growthTimer = 0.f;
-                    farm[finalTile].crop = aiFarmer.carriedSeed;
-                    aiFarmer.hasSeed = false;
-                    aiFarmer.carriedSeed = CropType::None;
-                    farm[finalTile].rect.setFillColor(sf::Color(51, 25, 0)); // darker soil
-                    std::cout << "AI: planted\n";
-                    aiState = AIState::WaitForGrowth;
-                } else {
-                    aiState = AIState::SelectGoal;
-                }
-            }
-            break;
-        }
-
-        case AIState::WaitForGrowth: {
-            // look for any grown crop of aiTargetCrop to harvest
-            int grownIdx = -1; float bd = 1e9;
-            for (int i = 0; i < static_cast<int>(farm.size()); ++i) {
-                if (farm[i].type == GroundType::Soil && farm[i].state == TileState::Grown && farm[i].crop == aiTargetCrop) {
-                    float d = std::hypot(tileCenter(i).x - aiPos.x, tileCenter(i).y - aiPos.y);
-                    if (d < bd) { bd = d; grownIdx = i; }
-                }
-            }
-            if (grownIdx >= 0) {
-                setAIPathToTile(grownIdx);
-                aiState = AIState::Harvest;
-            } else {
-                // do nothing this frame; you might let the AI wander or idle
-                // we'll let it remain in WaitForGrowth and recheck next frame
-            }
-            break;
-        }
-
-        case AIState::Harvest: {
-            if (aiPath.empty()) {
-                aiState = AIState::WaitForGrowth;
+            default:
                 break;
-            }
-            moveAIAlongPath(dt);
-            if (aiPathIndex >= static_cast<int>(aiPath.size())) {
-                int finalTile = aiPath.empty() ? -1 : aiPath.back();
-                if (finalTile >= 0 && farm[finalTile].state == TileState::Grown) {
-                    // harvest - mimic player logic
-                    farm[finalTile].state = TileState::Empty;
-                    aiFarmer.carriedSeed = farm[finalTile].crop;
-                    farm[finalTile].growthTimer = 0.f;
-                    farm[finalTile].rect.setFillColor(sf::Color(102, 51, 0)); // back to soil
-                    aiFarmer.hasProduct = true;
-                    std::cout << "AI: harvested " << cropName(aiFarmer.carriedSeed) << "\n";
-                    // go to market
-                    // find market tile
-                    int marketIdx = -1;
-                    float bestD = 1e9;
-                    for (int i = 0; i < static_cast<int>(farm.size()); ++i) {
-                        if (farm[i].type == GroundType::Market) {
-                            float d = std::hypot(tileCenter(i).x - aiPos.x, tileCenter(i).y - aiPos.y);
-                            if (d < bestD) { bestD = d; marketIdx = i; }
-                        }
-                    }
-                    if (marketIdx >= 0) { setAIPathToTile(marketIdx); aiState = AIState::GoToMarket; }
-                    else aiState = AIState::SelectGoal;
-                } else {
-                    aiState = AIState::WaitForGrowth;
-                }
-            }
-            break;
-        }
-
-        case AIState::GoToMarket: {
-            if (aiPath.empty()) { aiState = AIState::SelectGoal; break; }
-            moveAIAlongPath(dt);
-            if (aiPathIndex >= static_cast<int>(aiPath.size())) {
-                int finalTile = aiPath.empty() ? -1 : aiPath.back();
-                if (finalTile >= 0 && farm[finalTile].type == GroundType::Market && aiFarmer.hasProduct) {
-                    // sell to current request (reuse your player selling logic)
-                    CropType product = aiFarmer.carriedSeed;
-                    if (currentRequestIndex >= 0 && currentRequestIndex < static_cast<int>(requests.size())) {
-                        Request& r = requests[currentRequestIndex];
-                        bool completed = false;
-                        for (auto& item : r.items) {
-                            if (item.first == product && item.second > 0) {
-                                item.second -= 1;
-                                // find index to credit the AI
-                                for (size_t j = 0; j < r.items.size(); ++j) {
-                                    if (r.items[j].first == product) { r.aiContrib[j] += 1; break; }
-                                }
-                                completed = true;
-                                aiFarmer.score += 5; // 5 points per correct delivery
-                                aiCorrectDeliveries += 1;
-                                std::cout << "AI score +5\n";
-                                std::cout << "AI score: " << aiFarmer.score << "\n";
-                                break;
-                            }
-                        }
-                        if (completed) {
-                            std::cout << "AI: delivered " << cropName(product) << " for the request\n";
-                            updateCurrentRequestText();
-                            // show temporary sold visual on that market tile
-                            if (finalTile >= 0 && finalTile < static_cast<int>(farm.size())) {
-                                farm[finalTile].soldTimer = sold_visual_temp;
-                                farm[finalTile].soldCrop = product;
-                            }
-                            bool allDone = true;
-                            for (const auto& it : r.items) if (it.second > 0) { allDone = false; break; }
-                            if (allDone) {
-                                // determine exclusivity
-                                bool playerExclusive = true;
-                                bool aiExclusive = true;
-                                int totalQty = 0;
-                                for (size_t i = 0; i < r.items.size(); ++i) {
-                                    totalQty += r.initialQty[i];
-                                    if (r.playerContrib[i] != r.initialQty[i]) playerExclusive = false;
-                                    if (r.aiContrib[i] != r.initialQty[i]) aiExclusive = false;
-                                }
-                                if (playerExclusive) {
-                                    playerRequestsCompleted += 1;
-                                    playerFarmer.score += totalQty;
-                                }
-                                if (aiExclusive) {
-                                    aiRequestsCompleted += 1;
-                                    aiFarmer.score += totalQty;
-                                }
-
-                                currentRequestIndex++;
-                                if (currentRequestIndex < static_cast<int>(requests.size()) && hasFont) {
-                                    currentRequestText.setString("Request: " + requestToString(requests[currentRequestIndex]));
-                                } else {
-                                    currentRequestText.setString("All requests completed!");
-                                }
-                                updateCurrentRequestText();
-                            }
-                        } else {
-                            std::cout << "AI: wrong product for current request\n";
-                        }
-                    }
-                    aiFarmer.hasProduct = false;
-                    aiFarmer.carriedSeed = CropType::None;
-                    aiState = AIState::SelectGoal;
-                } else {
-                    aiState = AIState::SelectGoal;
-                }
-            }
-            break;
         }
+    }
+    if (requestChanged) updateCurrentRequestText();
 
-        case AIState::Idle:
-        default: {
-            // every few seconds re-evaluate
-            static float idleTimer = 0.f;
-            idleTimer += dt;
-            if (idleTimer > 0.2f) {
-                idleTimer = 0.f;
-                aiState = AIState::SelectGoal;
-            }
-            break;
-        }
-    } // end switch
-
-    if (popup.active) {
-        popup.timer += dt;
-        if (popup.timer >= popup.duration) {
-            popup.active = false; // stop showing it
-        }
+    if (!eventText.empty()) {
+        std::cout << eventText << std::flush;
+        eventText.clear();
     }
 }
 
@@ -1640,34 +613,48 @@ void Game::draw() {
         window.draw(currentRequestText);
     }
 
-    // Farm
-    for (auto& tile : farm) {
-        window.draw(tile.rect);
+    // Farm: recolour the tiles whose state changed, collect crop icons per texture
+    const FarmGrid& grid = sim.getGrid();
+    for (int i = 0; i < cropTextureCount; ++i) cropQuads[i].clear();
+
+    for (int i = 0; i < grid.size(); ++i) {
+        TileState state = sim.tileState(i);
+        if (state != shownTileStates[i]) colorTileQuad(i, state);
 
         //Seed box icons
-        if ((tile.type == GroundType::Seeds && tile.crop != CropType::None) || (tile.type == GroundType::Soil && tile.state == TileState::Grown && tile.crop != CropType::None)) {
-            sf::Sprite cropSprite;
-            cropSprite.setTexture(seedTexture(tile.crop));
-            cropSprite.setPosition(tile.rect.getPosition());
-
-            // scale down the sprite to fit in tile
-            auto texSize = cropSprite.getTexture()->getSize();
-            auto tileSize = tile.rect.getSize();
-            cropSprite.setScale( tileSize.x / texSize.x, tileSize.y/ texSize.y);
-            window.draw(cropSprite);
+        if ((grid.type[i] == GroundType::Seeds && grid.crop[i] != CropType::None) || (grid.type[i] == GroundType::Soil && state == TileState::Grown && grid.crop[i] != CropType::None)) {
+            sf::VertexArray& batch = cropQuads[static_cast<int>(grid.crop[i]) - 1];
+            sf::Vector2f texSize(seedTexture(grid.crop[i]).getSize());
+
+            // scale the icon to fill the tile
+            sf::FloatRect r = tileScreenRect(i);
+            batch.append(sf::Vertex({ r.left, r.top }, sf::Color::White, { 0.f, 0.f }));
+            batch.append(sf::Vertex({ r.left + r.width, r.top }, sf::Color::White, { texSize.x, 0.f }));
+            batch.append(sf::Vertex({ r.left + r.width, r.top + r.height }, sf::Color::White, { texSize.x, texSize.y }));
+            batch.append(sf::Vertex({ r.left, r.top + r.height }, sf::Color::White, { 0.f, texSize.y }));
         }
+    }
+
+    window.draw(tileQuads);
+    for (int i = 0; i < cropTextureCount; ++i) {
+        if (cropQuads[i].getVertexCount() == 0) continue;
+        window.draw(cropQuads[i], sf::RenderStates(&seedTexture(static_cast<CropType>(i + 1))));
+    }
+
+    // Temporary tile visuals (only the live ones are stored)
+    for (const TileEffect& fx : sim.getEffects()) {
+        sf::FloatRect rect = tileScreenRect(fx.tile);
 
-        // Draw temporary sold visual if present (fades out)
         // seed-taken visual: small sprite that rises and fades
-        if (tile.seedTakenTimer > 0.f && tile.seedTakenCrop != CropType::None) {
+        if (fx.type == EffectType::SeedTaken) {
             sf::Sprite takenSprite;
-            takenSprite.setTexture(seedTexture(tile.seedTakenCrop));
+            takenSprite.setTexture(seedTexture(fx.crop));
             // position starts at tile center
-            auto tilePos = tile.rect.getPosition();
-            auto tileSize = tile.rect.getSize();
+            sf::Vector2f tilePos(rect.left, rect.top);
+            sf::Vector2f tileSize(rect.width, rect.height);
             takenSprite.setOrigin(0.f, 0.f);
             // compute fraction (1.0 -> just started, 0.0 -> finished)
-            float fracSeed = std::max(0.f, tile.seedTakenTimer / seed_take_visual_temp);
+            float fracSeed = std::max(0.f, fx.timeLeft / fx.duration);
             // upward offset so the sprite rises while fading
             float yOffset = (1.f - fracSeed) * (tileSize.y * 0.6f);
             takenSprite.setPosition(tilePos.x, tilePos.y - yOffset);
@@ -1681,16 +668,17 @@ void Game::draw() {
             window.draw(takenSprite);
         }
 
-        if (tile.soldTimer > 0.f && tile.soldCrop != CropType::None) {
+        // sold visual: full-tile sprite that fades out
+        if (fx.type == EffectType::Sold) {
             sf::Sprite soldSprite;
-            soldSprite.setTexture(seedTexture(tile.soldCrop));
-            soldSprite.setPosition(tile.rect.getPosition());
+            soldSprite.setTexture(seedTexture(fx.crop));
+            soldSprite.setPosition(rect.left, rect.top);
             auto texSize2 = soldSprite.getTexture()->getSize();
-            auto tileSize2 = tile.rect.getSize();
+            sf::Vector2f tileSize2(rect.width, rect.height);
             soldSprite.setScale(tileSize2.x / texSize2.x, tileSize2.y / texSize2.y);
 
             // alpha proportional to remaining time (fade out)
-            float frac = std::min(1.f, tile.soldTimer / sold_visual_temp);
+            float frac = std::min(1.f, fx.timeLeft / fx.duration);
             sf::Color c = soldSprite.getColor();
             c.a = static_cast<sf::Uint8>(255.f * frac);
             soldSprite.setColor(c);
@@ -1700,10 +688,13 @@ void Game::draw() {
     }
 
     // Farmers (sprites-only)
-    window.draw(playerFarmer.sprite);
+    window.draw(playerSprite);
 
-    // AI (sprites-only)
-    window.draw(aiFarmer.sprite);
+    // AI (sprites-only, one shared sprite moved to each farmer)
+    for (const sf::Vector2f& p : aiScreenPositions) {
+        aiSprite.setPosition(p);
+        window.draw(aiSprite);
+    }
 
     // Pause popup
     if (PauseGame && hasFont) {
@@ -1720,7 +711,7 @@ void Game::draw() {
     }
 
     // End of game popup
-    if (EndGame && hasFont) {
+    if (sim.isGameOver() && hasFont) {
         sf::RectangleShape overlay(sf::Vector2f(window.getSize()));
         overlay.setFillColor(sf::Color(0, 0, 0, 180));
         window.draw(overlay);
@@ -1733,22 +724,22 @@ void Game::draw() {
         // End of game message
         std::string msg = "Game Over\n\n";
         msg += "Scores:\n";
-        msg += "You: " + std::to_string(playerFarmer.score) + "   AI: " + std::to_string(aiFarmer.score) + "\n\n";
+        msg += "You: " + std::to_string(sim.getPlayerScore()) + "   AI: " + std::to_string(sim.getAIScore()) + "\n\n";
         msg += "Requests dominated:\n";
-        msg += "You: " + std::to_string(playerRequestsCompleted) + "/" + std::to_string(numRequestsForLevel(levelID)) + "   AI: " + std::to_string(aiRequestsCompleted) + "/" + std::to_string(numRequestsForLevel(levelID)) + "\n";
+        msg += "You: " + std::to_string(sim.getPlayerRequestsCompleted()) + "/" + std::to_string(sim.numRequestsForLevel(sim.getLevelID())) + "   AI: " + std::to_string(sim.getAIRequestsCompleted()) + "/" + std::to_string(sim.numRequestsForLevel(sim.getLevelID())) + "\n";
         msg += "Correct deliveries:\n";
-        msg += "You: " + std::to_string(playerCorrectDeliveries) + "   AI: " + std::to_string(aiCorrectDeliveries) + "\n\n";
+        msg += "You: " + std::to_string(sim.getPlayerCorrectDeliveries()) + "   AI: " + std::to_string(sim.getAICorrectDeliveries()) + "\n\n";
 
-        if (winner == Winner::Player) {
+        if (sim.getWinner() == Winner::Player) {
             msg += "You won!\n\n";
-        } else if (winner == Winner::AI) {
+        } else if (sim.getWinner() == Winner::AI) {
             msg += "AI won!\n\n";
         } else {
             msg += "It's a tie! \n\n";
         }
 
         // If player won on level 1, offer a Next Level option
-        if (levelID == 1 && winner == Winner::Player) {
+        if (sim.getLevelID() == 1 && sim.getWinner() == Winner::Player) {
             msg += "Press N to go to Next Level\n";
         }
         msg += "Press P to play again\n";
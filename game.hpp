@@ -1,88 +1,19 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <vector>
+#include "gameSim.hpp"
+#include "snapshot.hpp"
+#include "replay.hpp"
 #include "player.hpp"
 #include "playerSave.hpp"
 #include "spriteLib.hpp"
 #include <iostream>
 #include <fstream>
-#include <random>
-
-#include <queue>
-#include <unordered_map>
-#include <cmath>
-#include <limits>
-#include <algorithm>
 
 
 //different game screen changes
 enum class GameAction { None, Back, Play, Next};
 
-//crop types
-enum class CropType { None, Carrot, Tomato, Lettuce, Corn, Potato };
-
-// State of a tile
-enum class TileState { Empty, Grown, Seeded, Watered, Suned, Marketed };
-
-enum class ActionType { None, Plant, Harvest, TakeSeed, TakeWater, TakeSun, DropWater, DropSun, DropProduct };
-
-enum class GroundType { Empty, Soil, Wall, Market, Seeds, Water, Sun, Trash };
-
-// --- Add near the Farmer / Request definitions in game.hpp ---
-// AI State machine for the AI farmer
-enum class AIState {
-    SelectGoal,
-    GoToSeeds,
-    PickSeeds,
-    GoToPlant,
-    Plant,
-    WaitForGrowth,
-    Harvest,
-    GoToMarket,
-    GoToTrash,
-    Sell,
-    Idle
-};
-
-// One soil tile in the farm
-struct FarmTile {
-    sf::RectangleShape rect;
-    TileState state = TileState::Empty;
-    GroundType type = GroundType::Empty;
-    CropType crop = CropType::None; 
-    float growthTimer = 0.f;
-    bool walkable = false;
-
-    // Visual indicator for a recent sale on this tile
-    float soldTimer = 0.f;  // remaining seconds for sold visual
-    CropType soldCrop = CropType::None; 
-    // Visual indicator for a recently taken seed from a seed box
-    float seedTakenTimer = 0.f; // remaining seconds for seed-taken visual
-    CropType seedTakenCrop = CropType::None; 
-};
-
-// One farmer (player or AI)
-struct Farmer {
-    sf::CircleShape body;
-    sf::Sprite sprite;
-    sf::Vector2f velocity{0.f, 0.f};
-    int score = 0;
-    bool hasSeed = false;
-    bool hasWater = false;
-    bool hasSun = false;
-    bool hasProduct = false;
-    CropType carriedSeed = CropType::None;
-};
-
-// One market request: up to 3 different crops with quantities
-struct Request {
-    std::vector<std::pair<CropType, int>> items;  // (crop, remaining quantity)
-    std::vector<int> initialQty;                  // initial requested quantities (aligned with items)
-    std::vector<int> playerContrib;               // how many units the player has delivered per item
-    std::vector<int> aiContrib;                   // how many units the AI has delivered per item
-    bool completed = false;
-};
-
 struct Popup {
     sf::Text text; // text to display
     bool useText = false;
@@ -95,6 +26,13 @@ struct Popup {
 class Game {
 public:
     explicit Game(sf::RenderWindow& window, int levelID = 1);
+    // Watch a recorded match: the replay drives the sim instead of the keyboard
+    Game(sf::RenderWindow& window, ReplayPlayer& replay);
+
+    // Every match played is recorded here (replaced by the next one)
+    static constexpr const char* lastReplayPath = "../../../save_files/last_match.replay";
+    // Debugging keys (Backspace rewinds the match); off unless started with --debug
+    static bool debugKeys;
 
     void handleEvent(const sf::Event& e);
     void update(float dt);
@@ -103,7 +41,7 @@ public:
     GameAction getAction() const { return action; }
     void clearAction() { action = GameAction::None; }
 
-    void setSpeed(float s) { speed = s; } // from Level page
+    void setSpeed(float s) { sim.setPlayerSpeed(s); recorder.recordSpeed(s, sim.getTick()); } // from Level page
 
     bool getTutorial() const { return Tutorial; }
     void setTutorial(bool t) { Tutorial = t; }
@@ -116,13 +54,29 @@ public:
     void recomputeLayout();
     Popup popup;
 
-    void decideWinnerOnGameEnd();
-
 private:
+    Game(sf::RenderWindow& window, int levelID, std::uint32_t seed, ReplayPlayer* replay);
+
     sf::RenderWindow& window;
 
+    // Simulation of the match (everything that is not drawing lives there)
+    GameSim sim;
+
+    // Fixed-step driver: real frame time is banked and spent in GameSim::fixedStep slices
+    static constexpr int maxStepsPerFrame = 8; // after a long hitch, drop time instead of spiralling
+    float accumulator = 0.f;
+    PlayerInput pendingInput; // T/D presses waiting for the next step
+
+    // Last few seconds of the match, captured every step (Backspace rewinds with debugKeys)
+    static constexpr float rewindStepBack = 2.f;
+    RewindBuffer rewind;
+    void rewindMatch(float seconds);
+
+    // Replay: the match being recorded, or the one being watched (not owned)
+    ReplayRecorder recorder;
+    ReplayPlayer* replay = nullptr;
+
     // Core
-    float speed = 200.f;
     bool PauseGame { false };
     bool Tutorial { false };
 
@@ -134,11 +88,6 @@ private:
     sf::RectangleShape rightBar;
     sf::RectangleShape centerPath;
 
-    //Winner options
-    bool EndGame {false};
-    enum class Winner {None, AI, Player, Tie};
-    Winner winner {Winner::None};
-
     // Font & HUD
     sf::Font font;
     bool hasFont = false;
@@ -161,18 +110,38 @@ private:
     InfoBoard timer;
     InfoBoard board;
 
-    // Farm grid
-    std::vector<FarmTile> farm;
-    int gridCols = 12;
-    int gridRows = 6;
+    // Farm grid geometry: one quad per sim tile in screen space, drawn in a single call.
+    // Quads are only recoloured when the tile state they show changes.
+    sf::VertexArray tileQuads;
+    std::vector<TileState> shownTileStates;
     sf::Vector2f gridOrigin;
+    sf::Vector2f simScale{1.f, 1.f}; // screen pixels per sim unit
+    sf::Vector2f tileScreenSize;
     float tileSize = 80.f;
 
+    // Seed box / grown crop icons, batched per crop texture and refilled every frame
+    static constexpr int cropTextureCount = 5;
+    sf::VertexArray cropQuads[cropTextureCount];
+
+    // Screen rectangle of a tile (inside its grid line)
+    sf::FloatRect tileScreenRect(int index) const;
+    void colorTileQuad(int index, TileState state);
+
     sf::FloatRect farmBounds;
 
-    // Farmers
-    Farmer playerFarmer;
-    Farmer aiFarmer;
+    // Sim position -> screen position
+    sf::Vector2f toScreen(const sf::Vector2f& p) const;
+    // Farmer position between the last two sim steps, on screen
+    sf::Vector2f interpolatedScreenPos(const sf::Vector2f& prev, const sf::Vector2f& pos) const;
+
+    // Farmer sprites (base scale at one screen pixel per sim unit)
+    sf::Sprite playerSprite;
+    sf::Sprite aiSprite;
+    // Where aiSprite is drawn, one entry per AI farmer
+    std::vector<sf::Vector2f> aiScreenPositions;
+    void placeAISprites(bool interpolate);
+    float playerSpriteScale = 1.f;
+    float aiSpriteScale = 1.f;
 
     //Crop textures
     sf::Texture carrotTexture;
@@ -188,52 +157,16 @@ private:
     sf::Text aiScoreText;
     sf::Text timerText;
 
-    // Match timer
-    float gameTimer = 0.f; //set in constructor
-    float initialTimeForLevel(int level) const;
-
-
     GameAction action { GameAction::None };
 
-    // Requests / Orders
-    std::vector<Request> requests;
-    int currentRequestIndex = 0;
-    int levelID = 1;
-
     // Make sure we only save the score once per game end
     bool scoreSaved = false;
 
-    // Counters for how many whole requests each side completed
-    int playerRequestsCompleted = 0;
-    int aiRequestsCompleted = 0;
-    // Total number of correct deliveries (useful veg delivered) by each side
-    int playerCorrectDeliveries = 0;
-    int aiCorrectDeliveries = 0;
-
     sf::Text currentRequestText;
 
-    // Request helpers
-    std::vector<CropType> allowedCropsForLevel(int level) const;
-    int maxQtyForLevel(int level) const;
-    int numRequestsForLevel(int level) const;
-    Request makeRandomRequest(int level);
-    std::string requestToString(const Request& r) const;
     void updateCurrentRequestText();
-
-    // AI-related members 
-    AIState aiState = AIState::SelectGoal;
-    CropType aiTargetCrop = CropType::None; // what the AI is currently trying to produce
-    std::vector<int> aiPath; // sequence of tile indices (A* result)
-    int aiPathIndex = 0; // next waypoint index in aiPath
-    float aiMaxSpeed = 175.f; // AI movement speed
-    float aiArriveThreshold = 10.f; // pixels to consider 'arrived' at a waypoint
-
-    // AI helpers
-    int tileIndexFromPos(const sf::Vector2f& pos) const;
-    sf::Vector2f tileCenter(int index) const;
-    bool isTileWalkable(int index) const;
-
-    // A* pathfinding for AI
-    std::vector<int> findPathAStar(int startIdx, int goalIdx);
+    void syncHud();
+    // React to what happened in the steps of this frame (popups, request text, log, save)
+    void handleSimEvents();
+    std::string eventText; // console lines of one frame, written at once
 };
-
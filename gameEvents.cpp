@@ -0,0 +1,46 @@
+#include "gameEvents.hpp"
+#include "gameSim.hpp"
+
+constexpr std::uint32_t EventQueue::capacity;
+
+static std::string farmerName(const GameEvent& e) {
+    if (e.farmer < 0) return "Player";
+    return (e.side == Side::AI ? "AI " : "Helper ") + std::to_string(e.farmer);
+}
+
+static const char* itemName(const GameEvent& e) {
+    switch (e.item) {
+        case Item::Water: return "Water";
+        case Item::Sun:   return "Sun";
+        default:          return GameSim::cropName(e.crop);
+    }
+}
+
+void appendEventText(std::string& out, const GameEvent& e) {
+    const std::string who = farmerName(e);
+    switch (e.type) {
+        case GameEventType::SeedTaken: out += who + ": " + GameSim::cropName(e.crop) + " seed taken\n"; break;
+        case GameEventType::WaterTaken: out += who + ": Water taken\n"; break;
+        case GameEventType::SunTaken:  out += who + ": Sun taken\n"; break;
+        case GameEventType::Planted:   out += who + ": " + GameSim::cropName(e.crop) + " seed planted\n"; break;
+        case GameEventType::Watered:   out += who + ": " + GameSim::cropName(e.crop) + " plant watered\n"; break;
+        case GameEventType::Sunned:    out += who + ": Sun dropped\n"; break;
+        case GameEventType::Harvested: out += who + ": " + GameSim::cropName(e.crop) + " harvested\n"; break;
+        case GameEventType::Delivered: {
+            int points = e.side == Side::Player ? e.playerPoints : e.aiPoints;
+            if (points > 0) out += who + " delivered " + GameSim::cropName(e.crop) + " for the request, score +" + std::to_string(points) + "\n";
+            else out += who + ": " + GameSim::cropName(e.crop) + " is not needed for the current request\n";
+            break;
+        }
+        case GameEventType::Discarded: out += who + ": " + itemName(e) + " discarded\n"; break;
+        case GameEventType::RequestCompleted:
+            out += "Request " + std::to_string(e.request + 1) + " completed! Bonus: player +" + std::to_string(e.playerPoints)
+                 + ", AI +" + std::to_string(e.aiPoints) + "\n";
+            break;
+        case GameEventType::MatchEnded: {
+            const char* result = e.winner == Winner::Player ? "player wins" : e.winner == Winner::AI ? "AI wins" : "tie";
+            out += std::string("Match over: ") + result + "\n";
+            break;
+        }
+    }
+}
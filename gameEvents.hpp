@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "farmGrid.hpp"
+#include "aiAgents.hpp"
+
+enum class Winner { None, AI, Player, Tie };
+
+// Something that happened in a match, for whoever shows, stores or plays it (HUD, log,
+// save file). The sim only fills these in; the text and I/O happen in the consumer.
+enum class GameEventType : std::uint8_t {
+    SeedTaken,
+    WaterTaken,
+    SunTaken,
+    Planted,
+    Watered,
+    Sunned,
+    Harvested,
+    Delivered,        // a product handed in at a market (useful or not, see points)
+    Discarded,        // something thrown in the trash (see item)
+    RequestCompleted, // the last missing item of a request was delivered
+    MatchEnded
+};
+
+// What a farmer can carry (for Discarded)
+enum class Item : std::uint8_t { None, Seed, Water, Sun, Product };
+
+struct GameEvent {
+    std::uint32_t tick = 0;
+    GameEventType type = GameEventType::SeedTaken;
+    Side side = Side::Player;      // side of the farmer who did it
+    std::int16_t farmer = -1;      // AI agent index, -1 for the player
+    CropType crop = CropType::None;
+    Item item = Item::None;
+    Winner winner = Winner::None;  // MatchEnded
+    int tile = -1;
+    int request = -1;              // index of the request (Delivered, RequestCompleted)
+    int playerPoints = 0;          // points each side gained by this event
+    int aiPoints = 0;
+};
+
+// Console line for an event ("Player: Tomato seed planted"), appended to out
+void appendEventText(std::string& out, const GameEvent& e);
+
+// Single-producer / single-consumer ring of events without locks: the sim pushes during
+// a step, the view drains once per frame. When nobody drains, new events are dropped
+// (and counted), the match itself never waits for a consumer.
+class EventQueue {
+public:
+    static constexpr std::uint32_t capacity = 1024; // power of two
+
+    bool push(const GameEvent& e) {
+        std::uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        ring[t & (capacity - 1)] = e;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(GameEvent& e) {
+        std::uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        e = ring[h & (capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Events lost because the queue was full
+    std::uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::array<GameEvent, capacity> ring;
+    std::atomic<std::uint32_t> head{0}; // next to pop (consumer)
+    std::atomic<std::uint32_t> tail{0}; // next to push (producer)
+    std::atomic<std::uint32_t> dropped{0};
+};
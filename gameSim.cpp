@@ -0,0 +1,1549 @@
+#include "gameSim.hpp"
+#include "snapshot.hpp"
+
+constexpr float GameSim::tileWidth;
+constexpr float GameSim::tileHeight;
+constexpr int GameSim::maxGridSize;
+constexpr float GameSim::fixedStep;
+constexpr float GameSim::growSeconds;
+constexpr int GameSim::agentsPerJob;
+constexpr int GameSim::endlessLookAhead;
+constexpr int GameSim::flowTargets;
+constexpr std::size_t GameSim::tileSnapshotBytes;
+
+// Convert position to tile index (or -1 if outside)
+int GameSim::tileIndexFromPos(const sf::Vector2f& pos) const {
+    // pos is already relative to the top-left of the grid
+    if (pos.x < 0 || pos.y < 0) return -1;
+
+    int col = static_cast<int>(pos.x * layout.invTileSize.x);
+    int row = static_cast<int>(pos.y * layout.invTileSize.y);
+
+    if (col >= gridCols || row >= gridRows) return -1;
+    return row * gridCols + col;
+}
+
+// Tile center coordinates
+sf::Vector2f GameSim::tileCenter(int index) const {
+    if (index < 0 || index >= grid.size()) return {0.f, 0.f};
+    int col = index % gridCols;
+    int row = index / gridCols;
+    return { (col + 0.5f) * layout.tileSize.x, (row + 0.5f) * layout.tileSize.y };
+}
+
+TileState GameSim::tileState(int index) const {
+    TileState s = grid.state[index];
+    if (isGrowing(s) && grid.type[index] == GroundType::Soil && tick >= grid.readyTick[index])
+        return TileState::Grown;
+    return s;
+}
+
+// (Re)start the growth timer of a planted tile
+void GameSim::scheduleGrowth(int index) {
+    grid.readyTick[index] = tick + static_cast<std::uint32_t>(growSeconds / fixedStep + 0.5f);
+    markTileDirty(index);
+    growthQueue.push({grid.readyTick[index], index});
+}
+
+// Flip the tiles that are due this step to Grown
+void GameSim::processGrowth() {
+    while (!growthQueue.empty() && growthQueue.top().first <= tick) {
+        int idx = growthQueue.top().second;
+        std::uint32_t due = growthQueue.top().first;
+        growthQueue.pop();
+
+        // stale entry: harvested, or the timer was restarted since
+        if (!isGrowing(grid.state[idx]) || grid.readyTick[idx] != due) continue;
+        if (grid.type[idx] != GroundType::Soil) continue;
+        setTileState(idx, TileState::Grown);
+    }
+}
+
+void GameSim::setTileState(int index, TileState s) {
+    grid.state[index] = s;
+    targets.update(grid, index);
+    markTileDirty(index);
+}
+
+void GameSim::markTileDirty(int index) {
+    if (tileDirty[index]) return;
+    tileDirty[index] = 1;
+    dirtyTiles.push_back(index); // reserved to grid size, never reallocates
+}
+
+void GameSim::clearDirtyTiles() {
+    for (int i : dirtyTiles) tileDirty[i] = 0;
+    dirtyTiles.clear();
+}
+
+// Is p on the tile itself (tiles are 1 unit smaller than their slot on each side)
+bool GameSim::tileContains(int index, const sf::Vector2f& p) const {
+    float left = (index % gridCols) * layout.tileSize.x + 1.f;
+    float top = (index / gridCols) * layout.tileSize.y + 1.f;
+    return p.x >= left && p.x < left + layout.tileSize.x - 2.f &&
+           p.y >= top && p.y < top + layout.tileSize.y - 2.f;
+}
+
+bool GameSim::isTileWalkable(int index) const {
+    if (index < 0 || index >= grid.size()) return false;
+    return grid.walkable[index];
+}
+
+void GameSim::setTileWalkable(int index, bool walkable) {
+    if (index < 0 || index >= grid.size() || (grid.walkable[index] != 0) == walkable) return;
+    grid.walkable[index] = walkable ? 1 : 0;
+    targets.update(grid, index);
+    markTileDirty(index);
+    walkabilityChanged(index);
+    walkChanges.push_back(index);
+}
+
+// Bring what's derived from walkability up to date with the tile
+void GameSim::walkabilityChanged(int index) {
+    walkVersion++;
+    for (HierarchicalPaths& h : hierarchy) h.tileChanged(index);
+    for (Side s : { Side::Player, Side::AI }) walkBits[static_cast<std::size_t>(s)].update(sideGrid(s), index);
+}
+
+// Check that a circle of radius r at centre stays fully inside the play area
+bool GameSim::insidePlayArea(const sf::Vector2f& centre, float r) const {
+    return centre.x - r >= 0.f && centre.x + r < layout.playWidth &&
+           centre.y - r >= 0.f && centre.y + r < layout.playHeight;
+}
+
+bool GameSim::onSide(Side s, const sf::Vector2f& centre, float r) const {
+    return s == Side::AI ? centre.x - r >= layout.wallRight : centre.x + r <= layout.wallLeft;
+}
+
+
+// The tiles a farmer of that side may walk on
+PathGrid GameSim::sideGrid(Side side) const {
+    PathGrid pg;
+    pg.walkable = grid.walkable.data();
+    pg.cols = gridCols;
+    pg.rows = gridRows;
+    pg.minCol = sideMinCol(side);
+    pg.endCol = sideEndCol(side);
+    pg.bits = &walkBits[static_cast<std::size_t>(side)];
+    return pg;
+}
+
+// Path for a farmer of that side, with the match's path algorithm, into path (reusing
+// its storage); false if the goal can't be reached
+bool GameSim::findPath(int startIdx, int goalIdx, Side side, std::vector<int>& path) const {
+    const PathGrid pg = sideGrid(side);
+    const HierarchicalPaths& h = hierarchy[static_cast<std::size_t>(side)];
+    if (pathAlgorithm == PathAlgorithm::Hierarchical && h.isBuilt()) {
+        return pathCache.findPath(pathAlgorithm, pg, startIdx, goalIdx, walkVersion, path,
+                                  [&](std::vector<int>& out) { h.findPath(startIdx, goalIdx, out); });
+    }
+    return pathCache.findPath(pathAlgorithm, pg, startIdx, goalIdx, walkVersion, path);
+}
+
+// Hand the changed tiles to the planners whose path they may cross, and ask for the repair
+void GameSim::repairPlans() {
+    if (pathAlgorithm == PathAlgorithm::DStarLite) {
+        for (int a = 0; a < agents.size(); ++a) {
+            DStarLite& planner = planners[a];
+            const std::vector<int>& path = agents.path[a];
+            if (!planner.isActive() || path.empty() || path.back() != planner.getGoal()) continue;
+            if (agents.pathIndex[a] >= static_cast<int>(path.size())) continue;
+            for (int t : walkChanges) planner.tileChanged(t);
+            requestPath(a, planner.getGoal());
+        }
+    }
+    walkChanges.clear();
+}
+
+void GameSim::refreshHierarchy() {
+    for (Side s : { Side::Player, Side::AI }) {
+        HierarchicalPaths& h = hierarchy[static_cast<std::size_t>(s)];
+        if (h.isBuilt()) h.update();
+        else h.build(sideGrid(s));
+    }
+}
+
+// Field of a side: market, trash, then the seed boxes of each crop
+int GameSim::flowSlot(Side s, TargetKind kind, CropType crop) {
+    int slot = kind == TargetKind::Market ? 0 : kind == TargetKind::Trash ? 1 : 1 + static_cast<int>(crop);
+    return (s == Side::AI ? flowTargets : 0) + slot;
+}
+
+void GameSim::refreshFlowFields() {
+    const bool diagonal = isDiagonal(pathAlgorithm);
+    if (flowVersion == walkVersion && flowFields[0].isDiagonal() == diagonal) return;
+    flowVersion = walkVersion;
+
+    std::array<std::vector<int>, 2 * flowTargets> goals;
+    for (int i = 0; i < grid.size(); ++i) {
+        if (!grid.walkable[i]) continue;
+        const Side s = i % gridCols >= sideMinCol(Side::AI) ? Side::AI : Side::Player;
+        switch (grid.type[i]) {
+            case GroundType::Market: goals[flowSlot(s, TargetKind::Market, CropType::None)].push_back(i); break;
+            case GroundType::Trash:  goals[flowSlot(s, TargetKind::Trash, CropType::None)].push_back(i); break;
+            case GroundType::Seeds:
+                if (grid.crop[i] != CropType::None) goals[flowSlot(s, TargetKind::Seeds, grid.crop[i])].push_back(i);
+                break;
+            default: break;
+        }
+    }
+    for (Side s : { Side::Player, Side::AI }) {
+        const PathGrid pg = sideGrid(s);
+        const int first = flowSlot(s, TargetKind::Market, CropType::None);
+        for (int f = first; f < first + flowTargets; ++f) flowFields[f].build(pg, goals[f], diagonal);
+    }
+}
+
+// Flood each side's open tiles area by area. 4 directions are enough: the 8-directional
+// searches never cut corners, so they connect the same tiles.
+void GameSim::refreshAreas() {
+    if (areaVersion == walkVersion) return;
+    areaVersion = walkVersion;
+    std::fill(areaOf.begin(), areaOf.end(), -1);
+
+    const int dx[4] = {1, -1, 0, 0};
+    const int dy[4] = {0, 0, 1, -1};
+    int areas = 0;
+    for (Side s : { Side::Player, Side::AI }) {
+        const PathGrid pg = sideGrid(s);
+        for (int i = 0; i < grid.size(); ++i) {
+            if (areaOf[i] >= 0 || !pg.open(i % gridCols, i / gridCols)) continue;
+            areaOf[i] = areas;
+            areaQueue.clear();
+            areaQueue.push_back(i);
+            for (std::size_t head = 0; head < areaQueue.size(); ++head) {
+                const int x = areaQueue[head] % gridCols, y = areaQueue[head] / gridCols;
+                for (int k = 0; k < 4; ++k) {
+                    const int n = (y + dy[k]) * gridCols + x + dx[k];
+                    if (!pg.open(x + dx[k], y + dy[k]) || areaOf[n] >= 0) continue;
+                    areaOf[n] = areas;
+                    areaQueue.push_back(n);
+                }
+            }
+            areas++;
+        }
+    }
+}
+
+// Helper to convert from char in level file to GroundType and CropType
+static void charToGroundType(char c, GroundType& gt, CropType& ct) {
+    gt = GroundType::Empty;
+    ct = CropType::None;
+
+    switch (c) {
+    case 'T':
+        gt = GroundType::Soil;
+        break;
+        // Seed boxes
+            case '1':   // tomato seeds
+                gt = GroundType::Seeds;
+                ct = CropType::Tomato;
+                break;
+            case '2':   // corn seeds
+                gt = GroundType::Seeds;
+                ct = CropType::Corn;
+                break;
+            case '3':   // potato seeds
+                gt = GroundType::Seeds;
+                ct = CropType::Potato;
+                break;
+            case '4':   // carrot seeds
+                gt = GroundType::Seeds;
+                ct = CropType::Carrot;
+                break;
+            case '5':   // lettuce seeds
+                gt = GroundType::Seeds;
+                ct = CropType::Lettuce;
+                break;
+
+    case 'G':
+         gt = GroundType::Seeds;
+        break;
+    case 'E':
+        gt = GroundType::Water;
+        break;
+    case 'S':
+        gt = GroundType::Sun;
+        break;
+    case 'M':
+        gt = GroundType::Market;
+        break;
+    case 'P':
+        gt = GroundType::Trash;
+        break;
+    case 'F':
+        gt = GroundType::Empty;
+        break;
+    case 'W':
+        gt = GroundType::Wall;
+        break;
+    default :
+        gt = GroundType::Empty;
+        break;
+    }
+}
+
+// Helper to get crop name as string
+const char* GameSim::cropName(CropType c) {
+    switch (c) {
+    case CropType::Carrot:  return "Carrot";
+    case CropType::Tomato:  return "Tomato";
+    case CropType::Lettuce: return "Lettuce";
+    case CropType::Corn:    return "Corn";
+    case CropType::Potato:  return "Potato";
+    case CropType::None:
+    default:
+        return "None";
+    }
+}
+
+// Convert a Request to a human-readable string
+std::string GameSim::requestToString(const Request& r) const {
+    if (r.itemCount == 0)
+        return "No request";
+
+    std::string s;
+    for (const Request::Item& item : r) {
+        CropType ct = item.crop;
+        int qty = item.remaining;
+        if (qty <= 0) continue;  // already fulfilled
+
+        if (!s.empty())
+            s += "  |  ";
+
+        s += std::to_string(qty);
+        s += "x ";
+        s += cropName(ct);
+    }
+    if (s.empty())
+        s = "Completed";
+    return s;
+}
+
+
+
+// Seed for a new match (replays pass the recorded one instead)
+std::uint32_t GameSim::randomSeed() {
+    return std::random_device{}();
+}
+
+// Uniform int in [lo, hi] straight from the mt19937 output. std:: distributions are
+// free to differ between standard libraries, which would break replays across builds.
+int GameSim::randomInt(int lo, int hi) {
+    std::uint32_t range = static_cast<std::uint32_t>(hi - lo) + 1;
+    std::uint32_t limit = std::numeric_limits<std::uint32_t>::max() - std::numeric_limits<std::uint32_t>::max() % range;
+    std::uint32_t v;
+    do { v = rng(); } while (v >= limit);
+    return lo + static_cast<int>(v % range);
+}
+
+// Which crops are allowed per level
+std::vector<CropType> GameSim::allowedCropsForLevel(int level) const {
+    switch (level) {
+        case 1:  // level 1 : T, P, Ca
+            return { CropType::Tomato, CropType::Potato, CropType::Carrot };
+        case 2:  // level 2 : T, P, Ca, L
+            return { CropType::Tomato, CropType::Potato, CropType::Carrot, CropType::Lettuce };
+        case 3:  // level 3 : T, P, Ca, L, Co
+        case 4:  // level 4 : same variety, harder numbers
+        default:
+            return { CropType::Tomato, CropType::Potato, CropType::Carrot,
+                     CropType::Lettuce, CropType::Corn };
+    }
+}
+
+// Max quantity per vegetable type, per level
+int GameSim::maxQtyForLevel(int level) const {
+    if (rules.maxQty > 0) return rules.maxQty;
+    switch (level) {
+        case 1: return 3;  // from your examples
+        case 2: return 3;
+        case 3: return 4;
+        case 4: return 5;
+        default: return 5;
+    }
+}
+
+// How many requests per level
+int GameSim::numRequestsForLevel(int level) const {
+    if (rules.numRequests > 0) return rules.numRequests;
+    switch (level) {
+        case 1: return 5;
+        case 2: return 7;
+        case 3: return 9;
+        case 4: return 12;
+        default: return 5;
+    }
+}
+
+// Generate one random request respecting all your rules
+Request GameSim::makeRandomRequest(int level) {
+    Request r;
+
+    auto allowed = allowedCropsForLevel(level);
+    int maxQty   = maxQtyForLevel(level);
+
+    if (allowed.empty()) return r;
+
+    //decide how many different vegetables (1..3, but not more than allowed.size())
+    int maxTypes = static_cast<int>(std::min<size_t>(3, allowed.size()));
+    int k = randomInt(1, maxTypes);   // number of different crops in this request
+
+    //choose k distinct crops: shuffle then take first k
+    for (int i = static_cast<int>(allowed.size()) - 1; i > 0; --i) {
+        std::swap(allowed[i], allowed[randomInt(0, i)]);
+    }
+
+    //for each chosen crop, choose a quantity 1..maxQty
+    for (int i = 0; i < k; ++i) {
+        CropType ct = allowed[i];
+        int qty = randomInt(1, maxQty);
+        r.add(ct, qty);
+    }
+
+    return r;
+}
+
+float GameSim::initialTimeForLevel(int level) const
+{
+    if (rules.matchSeconds > 0.f) return rules.matchSeconds;
+    switch (level) {
+        case 1:  return 80.f;  // 1m20
+        case 2:  return 120.f;  // 2m
+        case 3:  return 140.f;  // 2m20
+        case 4:  return 180.f; // 3m
+        default: return 80.f;
+    }
+}
+
+// Load the level into the farm grid. A level file is an optional "size <cols> <rows>" line
+// followed by one line of tile characters per row. Without the size line the grid is as
+// wide as the first row and has one row per line; short or missing rows are floor.
+void GameSim::loadLevel() {
+    std::string levelPath = "res/levels/level" + std::to_string(levelID) + ".txt";
+
+    std::ifstream in(levelPath);
+    if (!in) {
+        std::cerr << "[ERROR] Cannot open level file: " << levelPath << "\n";
+        // fall back: keep default GroundType::Empty for all tiles
+        grid.resize(gridCols, gridRows);
+        return;
+    }
+
+    std::vector<std::string> lines;
+    int declaredCols = 0;
+    int declaredRows = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') // Windows line endings
+            line.pop_back();
+        if (lines.empty() && declaredCols == 0 && line.compare(0, 5, "size ") == 0) {
+            std::istringstream header(line.substr(5));
+            header >> declaredCols >> declaredRows;
+            continue;
+        }
+        if (!line.empty())
+            lines.push_back(line);
+    }
+
+    int cols = declaredCols > 0 ? declaredCols : (lines.empty() ? 0 : static_cast<int>(lines[0].size()));
+    int rows = declaredRows > 0 ? declaredRows : static_cast<int>(lines.size());
+    if (cols <= 0 || rows <= 0 || cols > maxGridSize || rows > maxGridSize) {
+        std::cerr << "[WARN] Level file " << levelPath << " has an invalid size (" << cols << "x" << rows << ")\n";
+        grid.resize(gridCols, gridRows);
+        return;
+    }
+    if (static_cast<int>(lines.size()) < rows) {
+        std::cerr << "[WARN] Level file has fewer than " << rows << " rows, the rest is floor\n";
+    }
+
+    gridCols = cols;
+    gridRows = rows;
+    grid.resize(gridCols, gridRows);
+
+    for (int row = 0; row < gridRows; ++row) {
+        const std::string* rowChars = row < static_cast<int>(lines.size()) ? &lines[row] : nullptr;
+        for (int col = 0; col < gridCols; ++col) {
+            int idx = row * gridCols + col;
+            char c = (rowChars && col < static_cast<int>(rowChars->size())) ? (*rowChars)[col] : 'F';
+
+            GroundType gt;
+            CropType ct;
+            charToGroundType(c, gt, ct);
+
+            grid.type[idx] = gt;
+            grid.crop[idx] = ct;
+            grid.walkable[idx] = (gt != GroundType::Wall); // walls are the only blocking ground
+        }
+    }
+    levelLoaded = true;
+}
+
+// Rebuild the cached play-area metrics from the grid size
+void GameSim::recomputeLayout() {
+    layout.tileSize = { tileWidth, tileHeight };
+    layout.invTileSize = { 1.f / tileWidth, 1.f / tileHeight };
+    layout.playWidth = gridCols * tileWidth;
+    layout.playHeight = gridRows * tileHeight;
+
+    // divider in the middle of the play area
+    layout.wallLeft = layout.playWidth / 2.f - 2.f;
+    layout.wallRight = layout.playWidth / 2.f + 2.f;
+    // tile centres past wallRight belong to the AI side, those before wallLeft to the player
+    layout.wallCol = static_cast<int>(std::floor(layout.wallRight * layout.invTileSize.x - 0.5f)) + 1;
+    layout.playerCols = static_cast<int>(std::ceil(layout.wallLeft * layout.invTileSize.x - 0.5f));
+}
+
+// Simulation constructor
+GameSim::GameSim(int levelID, std::uint32_t seed, const MatchRules& rules)
+    : levelID(levelID), seed(seed), rng(seed), rules(rules), pathAlgorithm(rules.pathAlgorithm),
+      pathCache(rules.pathCacheSize) {
+
+    // Create the farm grid from the level file (all walkable, nothing planted yet)
+    loadLevel();
+
+    recomputeLayout();
+    targets.build(grid, layout.tileSize.x, layout.tileSize.y);
+    for (Side s : { Side::Player, Side::AI }) walkBits[static_cast<std::size_t>(s)].build(sideGrid(s));
+    areaOf.assign(grid.size(), -1);
+    areaQueue.reserve(grid.size());
+    refreshAreas();
+    tileDirty.assign(grid.size(), 0);
+    dirtyTiles.reserve(grid.size());
+
+    gameTimer = initialTimeForLevel(levelID);
+
+    // Farmers start a quarter of the way in from their side, the player in the vertical centre
+    playerFarmer.position = { layout.playWidth * 0.25f, layout.playHeight * 0.5f };
+    playerFarmer.prevPosition = playerFarmer.position;
+    spawnAgents(Side::AI, rules.aiFarmers);
+    spawnAgents(Side::Player, rules.aiHelpers);
+    planners.resize(static_cast<std::size_t>(agents.size()));
+
+    // Generate requests for this level (all of them, or the first few in endless mode)
+    int nReq = rules.endless ? -1 : numRequestsForLevel(levelID);
+    orders.reset(rules.openRequests, rules.endless ? endlessLookAhead : nReq, nReq);
+    refillOrders();
+
+    // Debug: print them in console so you can see them
+    if (!rules.log) return;
+    std::cout << "=== Requests for level " << levelID << (rules.endless ? " (endless)" : "") << " ===\n";
+    auto print = [](const Request& r) {
+        std::cout << "Request " << r.id + 1 << ": ";
+
+        for (const Request::Item& item : r) {
+            CropType ct = item.crop;
+            int qty     = item.remaining;
+            std::cout << qty << "x " << cropName(ct) << "  ";
+        }
+
+        std::cout << "\n";
+    };
+    orders.forEachOpen(print);
+    for (int i = 0; i < orders.getUpcomingCount(); ++i) print(orders.getUpcoming(i));
+}
+
+// Top up the order book's look-ahead. In endless mode each request draws from the
+// generator seeded by (match seed, request number), so the generator never has to be
+// part of a snapshot.
+void GameSim::refillOrders() {
+    while (orders.wantsMore()) {
+        if (rules.endless) rng.seed(seed + 0x9E3779B9u * static_cast<std::uint32_t>(orders.getGenerated() + 1));
+        orders.add(makeRandomRequest(levelID));
+    }
+}
+
+void GameSim::publish(GameEventType type, Side side, int farmer, int tile, CropType crop) {
+    GameEvent e;
+    e.type = type;
+    e.side = side;
+    e.farmer = static_cast<std::int16_t>(farmer);
+    e.tile = tile;
+    e.crop = crop;
+    publish(e);
+}
+
+void GameSim::publish(GameEvent e) {
+    e.tick = tick;
+    events.push(e); // a full queue drops the event, the match goes on regardless
+}
+
+void GameSim::playerTake() {
+    if (EndGame) return;
+
+    // Player interacts with the tile under them, found straight from the grid metrics
+    sf::Vector2f p = playerFarmer.position;
+
+    int i = tileIndexFromPos(p);
+    if (i < 0 || !tileContains(i, p)) return; // off the grid, or on the line between two tiles
+
+    if (grid.type[i] == GroundType::Seeds && !playerFarmer.hasSeed) {
+        // take seed
+        playerFarmer.carriedSeed = grid.crop[i];
+        playerFarmer.hasSeed = true;
+        publish(GameEventType::SeedTaken, Side::Player, -1, i, grid.crop[i]);
+        // trigger a small visual on the seed box to indicate it was taken
+        effects.spawn(EffectType::SeedTaken, i, grid.crop[i], seed_take_visual_temp);
+        return;
+    }
+    if (grid.type[i] == GroundType::Water && !playerFarmer.hasWater) {
+        // take water
+        playerFarmer.hasWater = true;
+        publish(GameEventType::WaterTaken, Side::Player, -1, i, CropType::None);
+        return;
+    }
+    if (grid.type[i] == GroundType::Sun && !playerFarmer.hasSun) {
+        // take sun
+        playerFarmer.hasSun = true;
+        publish(GameEventType::SunTaken, Side::Player, -1, i, CropType::None);
+        return;
+    }
+    if (tileState(i) == TileState::Grown && grid.type[i] == GroundType::Soil) {
+        // harvest
+        setTileState(i, TileState::Empty);
+        playerFarmer.carriedSeed = grid.crop[i];
+        playerFarmer.hasProduct = true;
+        publish(GameEventType::Harvested, Side::Player, -1, i, grid.crop[i]);
+        return;
+    }
+    return;
+}
+
+void GameSim::playerDrop() {
+    if (EndGame) return;
+
+    // Player interacts with the tile under them, found straight from the grid metrics
+    sf::Vector2f p = playerFarmer.position;
+
+    int ti = tileIndexFromPos(p);
+    if (ti < 0 || !tileContains(ti, p)) return; // off the grid, or on the line between two tiles
+
+    if (grid.state[ti] == TileState::Empty && grid.type[ti] == GroundType::Soil && playerFarmer.hasSeed) {
+        // plant seed
+        grid.crop[ti] = playerFarmer.carriedSeed;
+        setTileState(ti, TileState::Seeded);
+        scheduleGrowth(ti);
+        playerFarmer.hasSeed = false;
+        playerFarmer.carriedSeed = CropType::None;
+        publish(GameEventType::Planted, Side::Player, -1, ti, grid.crop[ti]);
+        return;
+    }
+    if (tileState(ti) == TileState::Seeded && grid.type[ti] == GroundType::Soil && playerFarmer.hasWater) {
+        // drop water
+        setTileState(ti, TileState::Watered);
+        scheduleGrowth(ti);
+        playerFarmer.hasWater = false;
+        publish(GameEventType::Watered, Side::Player, -1, ti, grid.crop[ti]);
+        return;
+    }
+    if (tileState(ti) == TileState::Seeded && grid.type[ti] == GroundType::Soil && playerFarmer.hasSun) {
+        // drop sun
+        setTileState(ti, TileState::Suned);
+        scheduleGrowth(ti);
+        playerFarmer.hasSun = false;
+        publish(GameEventType::Sunned, Side::Player, -1, ti, grid.crop[ti]);
+        return;
+    }
+    if (grid.type[ti] == GroundType::Market && playerFarmer.hasProduct) {
+        // sell product
+        deliver(Side::Player, -1, ti, playerFarmer.carriedSeed);
+        playerFarmer.hasProduct = false;
+        playerFarmer.carriedSeed = CropType::None;
+        return;
+    }
+    if (grid.type[ti] == GroundType::Trash) {
+        GameEvent e;
+        e.type = GameEventType::Discarded;
+        e.tile = ti;
+        e.crop = playerFarmer.carriedSeed;
+        if (playerFarmer.hasSeed) {
+            playerFarmer.hasSeed = false;
+            e.item = Item::Seed;
+            playerFarmer.carriedSeed = CropType::None;
+        } else if (playerFarmer.hasWater) {
+            playerFarmer.hasWater = false;
+            e.item = Item::Water;
+        } else if (playerFarmer.hasSun) {
+            playerFarmer.hasSun = false;
+            e.item = Item::Sun;
+        } else if (playerFarmer.hasProduct) {
+            playerFarmer.hasProduct = false;
+            e.item = Item::Product;
+            playerFarmer.carriedSeed = CropType::None;
+        } else {
+            return;
+        }
+        publish(e);
+    }
+}
+
+// A farmer of that side (farmer = AI agent index, -1 for the player) hands in product at
+// marketTile. The one place deliveries are scored, for the player and every AI farmer.
+void GameSim::deliver(Side side, int farmer, int marketTile, CropType product) {
+    GameEvent delivered;
+    delivered.type = GameEventType::Delivered;
+    delivered.side = side;
+    delivered.farmer = static_cast<std::int16_t>(farmer);
+    delivered.tile = marketTile;
+    delivered.crop = product;
+
+    // the oldest open request needing the product takes it, attributed to the farmer's side
+    const OrderBook::Sale sale = orders.deliver(product, side);
+    delivered.request = sale.request;
+    if (sale.request >= 0) {
+        const bool playerSide = side == Side::Player;
+        (playerSide ? playerScore : aiScore) += 5; // give 5 points per required veg delivered
+        (playerSide ? playerCorrectDeliveries : aiCorrectDeliveries) += 1;
+        (playerSide ? delivered.playerPoints : delivered.aiPoints) = 5;
+    }
+    publish(delivered);
+    if (sale.request < 0) return;
+
+    // trigger a short "sold" visual on this market tile
+    effects.spawn(EffectType::Sold, marketTile, product, sold_visual_temp);
+
+    if (!sale.completed) return;
+
+    // The request is fulfilled (the order book reports that exactly once, and retires it)
+    const int N = sale.units;
+    const int playerDelivered = sale.playerUnits;
+    const int aiDelivered = sale.aiUnits;
+
+    // the side that delivered most of it gets 3 points per item, a tie splits that
+    GameEvent completed = delivered;
+    completed.type = GameEventType::RequestCompleted;
+    completed.playerPoints = 0;
+    completed.aiPoints = 0;
+    if (playerDelivered > aiDelivered) {
+        playerRequestsCompleted += 1; // dominated count
+        completed.playerPoints = 3 * N;
+    } else if (aiDelivered > playerDelivered) {
+        aiRequestsCompleted += 1;
+        completed.aiPoints = 3 * N;
+    } else {
+        int tieBonus = static_cast<int>(std::round((3.0 * N) / 2.0));
+        playerRequestsCompleted += 1;
+        aiRequestsCompleted += 1;
+        completed.playerPoints = tieBonus;
+        completed.aiPoints = tieBonus;
+    }
+    playerScore += completed.playerPoints;
+    aiScore += completed.aiPoints;
+    publish(completed);
+
+    refillOrders();
+    if (orders.allCompleted()) {
+        EndGame = true;
+        decideWinnerOnGameEnd();
+        publishMatchEnded();
+    }
+
+    // The other farmers were working on the finished request: make them abandon their
+    // current task so they immediately re-evaluate the new request.
+    for (int a = 0; a < agents.size(); ++a) {
+        if (a != farmer) agents.resetGoal(a);
+    }
+}
+
+void GameSim::publishMatchEnded() {
+    GameEvent e;
+    e.type = GameEventType::MatchEnded;
+    e.winner = winner;
+    publish(e);
+}
+
+void GameSim::decideWinnerOnGameEnd()
+{
+    if (playerScore > aiScore) {
+        winner = Winner::Player;
+    } else if (aiScore > playerScore) {
+        winner = Winner::AI;
+    } else {
+        winner = Winner::Tie;
+    }
+}
+
+void GameSim::step(const PlayerInput& input) {
+    if (EndGame) return;
+    refreshAreas();
+    if (rules.flowFields) refreshFlowFields();
+    if (pathAlgorithm == PathAlgorithm::Hierarchical) refreshHierarchy();
+    if (!walkChanges.empty()) repairPlans();
+
+    playerFarmer.prevPosition = playerFarmer.position;
+    std::copy(agents.position.begin(), agents.position.end(), agents.prevPosition.begin());
+
+    // discrete actions are applied at the start of the step they were queued for
+    if (input.take) playerTake();
+    if (input.drop) playerDrop();
+
+    update(fixedStep, input.move);
+    tick++;
+}
+
+// Place count agents of a side evenly down its quarter line, each on a walkable tile of its side
+void GameSim::spawnAgents(Side s, int count) {
+    const float x = layout.playWidth * (s == Side::AI ? 0.75f : 0.25f);
+    for (int i = 0; i < count; ++i) {
+        sf::Vector2f pos(x, layout.playHeight * (i + 1) / (count + 1));
+
+        int tile = tileIndexFromPos(pos);
+        int col = tile % gridCols;
+        if (tile < 0 || !isTileWalkable(tile) || col < sideMinCol(s) || col >= sideEndCol(s)) {
+            float bestD = std::numeric_limits<float>::max();
+            for (int t = 0; t < grid.size(); ++t) {
+                int c = t % gridCols;
+                if (c < sideMinCol(s) || c >= sideEndCol(s) || !isTileWalkable(t)) continue;
+                sf::Vector2f tc = tileCenter(t);
+                float d = (tc.x - pos.x) * (tc.x - pos.x) + (tc.y - pos.y) * (tc.y - pos.y);
+                if (d < bestD) { bestD = d; tile = t; }
+            }
+            if (bestD < std::numeric_limits<float>::max()) pos = tileCenter(tile);
+        }
+        agents.add(s, pos);
+    }
+}
+
+void GameSim::update(float dt, sf::Vector2f v) {
+    if (EndGame) return;
+
+    // normalise diagonal movement so speed is the same in all directions
+    if (v.x != 0.f || v.y != 0.f) {
+        float len = std::sqrt(v.x * v.x + v.y * v.y);
+        v /= len;
+    }
+
+    // Move player farmer
+
+    if (v.x != 0.f || v.y != 0.f) {
+        sf::Vector2f next = playerFarmer.position + v * playerSpeed * dt;
+        float r = playerFarmer.radius;
+
+        bool inside = insidePlayArea(next, r); // whole circle inside the playable zone
+        bool leftOfWall = (next.x + r) <= layout.wallLeft; // must stay on the left side of the wall
+
+        if (inside && leftOfWall && isTileWalkable(tileIndexFromPos(next))) {
+            playerFarmer.position = next;
+        }
+    }
+
+    // Agents and world, in the phases described in gameSim.hpp. A handful of agents is
+    // not worth handing out to other threads.
+    if (!jobs || agents.size() <= agentsPerJob) {
+        moveAgents(0, agents.size(), dt);
+        updateWorld(dt);
+        for (int a = 0; a < agents.size(); ++a) decideAgent(a, dt);
+        solvePaths(0, agents.size());
+        return;
+    }
+
+    // the number of agents is fixed for a match, so the graph is built once (per copy of
+    // the sim: the jobs point at the sim that built them)
+    stepDt = dt;
+    if (stepJobsOwner != this) {
+        stepJobs.clear();
+        stepJobsOwner = this;
+        const int n = agents.size();
+        auto walk = stepJobs.parallelFor(n, agentsPerJob, [this](int b, int e) { moveAgents(b, e, stepDt); });
+        auto world = stepJobs.add([this] { updateWorld(stepDt); });
+        auto decide = stepJobs.add([this] { for (int a = 0; a < agents.size(); ++a) decideAgent(a, stepDt); }, { walk, world });
+        stepJobs.parallelFor(n, agentsPerJob, [this](int b, int e) { solvePaths(b, e); }, { decide });
+    }
+    jobs->run(stepJobs);
+}
+
+// Walking: bounce, then follow the current path (agents [begin, end) only)
+void GameSim::moveAgents(int begin, int end, float dt) {
+    const float bounceStep = playerSpeed * 0.4f * dt;
+    for (int a = begin; a < end; ++a) {
+        // AI movement: simple left-right bouncing
+        sf::Vector2f aiNext = agents.position[a] + sf::Vector2f(agents.bounceDir[a] * bounceStep, 0.f);
+        float ar = agents.radius[a];
+
+        if (insidePlayArea(aiNext, ar) && onSide(agents.side[a], aiNext, ar) && isTileWalkable(tileIndexFromPos(aiNext))) {
+            agents.position[a] = aiNext;
+        } else {
+            agents.bounceDir[a] *= -1.f; // if next position would leave the area, bounce
+        }
+
+        switch (agents.state[a]) {
+            case AIState::GoToSeeds:
+            case AIState::GoToPlant:
+            case AIState::Harvest:
+            case AIState::GoToMarket:
+                moveAgentAlongPath(a, dt);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Crops growing, visual timers and the match timer
+void GameSim::updateWorld(float dt) {
+    // Grow crops (only the tiles whose time has come)
+    processGrowth();
+
+    // Update sold / seed-taken visual timers
+    effects.update(dt);
+
+    // update global timer
+    gameTimer -= dt;
+    if (gameTimer <= 0.f) {
+        gameTimer = 0.f;
+        if (!EndGame) {
+            EndGame = true;
+            // Determine winner with tiebreakers:
+            if (playerScore > aiScore) {
+                winner = Winner::Player;
+            } else if (aiScore > playerScore) {
+                winner = Winner::AI;
+            } else {
+                // tie on score -> compare number of requests dominated
+                if (playerRequestsCompleted > aiRequestsCompleted) winner = Winner::Player;
+                else if (aiRequestsCompleted > playerRequestsCompleted) winner = Winner::AI;
+                else {
+                    // still tie -> compare correct deliveries
+                    if (playerCorrectDeliveries > aiCorrectDeliveries) winner = Winner::Player;
+                    else if (aiCorrectDeliveries > playerCorrectDeliveries) winner = Winner::AI;
+                    else winner = Winner::Tie;
+                }
+            }
+            publishMatchEnded();
+        }
+    }
+}
+
+// Search the paths the agents [begin, end) asked for this step. Only reads the grid
+// and target index, which nothing changes during this phase.
+void GameSim::solvePaths(int begin, int end) {
+    for (int a = begin; a < end; ++a) {
+        if (agents.pathRequest[a] < 0) continue;
+        setAgentPathToTile(a, agents.pathRequest[a], agents.position[a]);
+        agents.pathRequest[a] = -1;
+    }
+}
+
+// Nearest target tile on that side of the divider that can be walked to from the tile
+// at from (any on that side if from isn't on an open tile)
+int GameSim::nearestTarget(Side s, TargetKind kind, CropType crop, const sf::Vector2f& from) const {
+    const int tile = tileIndexFromPos(from);
+    const int area = tile >= 0 ? areaOf[tile] : -1;
+    return targets.nearest(kind, crop, from, sideMinCol(s), sideEndCol(s), area >= 0 ? areaOf.data() : nullptr, area);
+}
+
+bool GameSim::headFor(int a, TargetKind kind, CropType crop, const sf::Vector2f& from) {
+    const Side side = agents.side[a];
+    const int start = tileIndexFromPos(from);
+    if (rules.flowFields) {
+        const FlowField& field = flowFields[flowSlot(side, kind, crop)];
+        // (an agent on a tile that got blocked under it searches its way out instead)
+        if (field.reaches(start)) {
+            field.trace(start, agents.path[a]);
+            smoothAgentPath(a);
+            agents.pathIndex[a] = 0;
+            agents.pathRequest[a] = -1;
+            return true;
+        }
+    }
+    int target = nearestTarget(side, kind, crop, from);
+    if (target < 0) return false;
+    requestPath(a, target);
+    return true;
+}
+
+// Set agent a's path to a tile index
+void GameSim::setAgentPathToTile(int a, int tileIdx, const sf::Vector2f& from) {
+    const Side side = agents.side[a];
+    std::vector<int>& path = agents.path[a];
+
+    int start = tileIndexFromPos(from);
+    if (start < 0) {
+        // fallback: compute from current position -> approximate nearest tile
+        // pick the tile under the agent
+        start = tileIndexFromPos(agents.position[a]);
+    }
+    searchAgentPath(a, start, tileIdx);
+    agents.pathIndex[a] = 0;
+
+    // If no path found (often because the goal is on the other side),
+    // try a fallback: find the nearest suitable tile on the agent's side
+    // and attempt to path to that instead.
+    if (!path.empty()) {
+        smoothAgentPath(a);
+        return;
+    }
+    if (tileIdx < 0 || tileIdx >= grid.size()) return;
+
+    // nearest tile of the same kind on our side (straight from the target index)
+    int bestCandidate = -1;
+    switch (grid.type[tileIdx]) {
+        case GroundType::Seeds:
+            bestCandidate = nearestTarget(side, TargetKind::Seeds, grid.crop[tileIdx], from);
+            break;
+        case GroundType::Soil:
+            // prefer soil tiles that are empty (planting target)
+            bestCandidate = nearestTarget(side, TargetKind::EmptySoil, CropType::None, from);
+            break;
+        case GroundType::Market:
+            bestCandidate = nearestTarget(side, TargetKind::Market, CropType::None, from);
+            break;
+        case GroundType::Trash:
+            bestCandidate = nearestTarget(side, TargetKind::Trash, CropType::None, from);
+            break;
+        default:
+            // the nearest walkable tile on our side: the one the agent is on
+            if (isTileWalkable(start) && start % gridCols >= sideMinCol(side) && start % gridCols < sideEndCol(side)) {
+                bestCandidate = start;
+            }
+            break;
+    }
+
+    if (bestCandidate >= 0 && bestCandidate != tileIdx && searchAgentPath(a, start, bestCandidate)) {
+        agents.pathIndex[a] = 0;
+        smoothAgentPath(a);
+    }
+}
+
+// Search agent a's path with the match's algorithm into agents.path[a]. With D* Lite it
+// is the agent's planner that searches (repairing its search if tiles changed on the
+// way to the same goal), so the path walked is always the one repairPlans repairs.
+bool GameSim::searchAgentPath(int a, int start, int goal) {
+    std::vector<int>& path = agents.path[a];
+    if (pathAlgorithm != PathAlgorithm::DStarLite) return findPath(start, goal, agents.side[a], path);
+
+    DStarLite& planner = planners[a];
+    if (planner.hasChanges() && planner.getGoal() == goal) planner.moveTo(start);
+    else planner.plan(sideGrid(agents.side[a]), start, goal);
+    return planner.path(path);
+}
+
+void GameSim::smoothAgentPath(int a) {
+    if (!rules.smoothPaths) return;
+    // the farmer leaves a corner from up to aiArriveThreshold away, so it may stray that
+    // far from the line (lines between tile centres never come near its side's edges)
+    smoothPath(sideGrid(agents.side[a]), agents.path[a], aiArriveThreshold / std::min(layout.tileSize.x, layout.tileSize.y));
+}
+
+void GameSim::moveAgentAlongPath(int a, float dt) {
+    std::vector<int>& path = agents.path[a];
+    int& pathIndex = agents.pathIndex[a];
+    if (path.empty() || pathIndex >= static_cast<int>(path.size())) return;
+
+    sf::Vector2f pos = agents.position[a];
+    sf::Vector2f target = tileCenter(path[pathIndex]);
+    sf::Vector2f dir = target - pos;
+    float dist = std::sqrt(dir.x*dir.x + dir.y*dir.y);
+    if (dist < aiArriveThreshold) { // reached waypoint
+        pathIndex++;
+        return;
+    }
+    if (rules.smoothPaths && pathIndex > 0) {
+        // the bounce pushes the farmer sideways, far off a long segment (and into what it
+        // was kept clear of): aim for the segment just ahead instead of at its end
+        const sf::Vector2f from = tileCenter(path[pathIndex - 1]);
+        sf::Vector2f along = target - from;
+        const float length = std::sqrt(along.x*along.x + along.y*along.y);
+        along /= std::max(length, 1e-6f);
+        const float done = (pos.x - from.x) * along.x + (pos.y - from.y) * along.y;
+        if (done + aiArriveThreshold < length) {
+            dir = from + along * (done + aiArriveThreshold) - pos;
+            dist = std::sqrt(dir.x*dir.x + dir.y*dir.y);
+        }
+    }
+    // normalise and apply speed (seek)
+    dir /= dist;
+    sf::Vector2f vel = dir * (aiMaxSpeed * dt);
+    // move the agent, but keep it on its side of the divider
+    float ar = agents.radius[a];
+    sf::Vector2f next = pos + vel;
+
+    if (insidePlayArea(next, ar) && onSide(agents.side[a], next, ar) && isTileWalkable(tileIndexFromPos(next))) {
+        agents.position[a] = next;
+    } else {
+        // cannot move directly; clear path so next iteration recalculates
+        path.clear();
+    }
+}
+
+// Nearest grown crop of any kind on that side, -1 if none
+int GameSim::nearestGrown(Side s, const sf::Vector2f& from) const {
+    int best = -1;
+    float bestD = std::numeric_limits<float>::max();
+    for (CropType c : { CropType::Carrot, CropType::Tomato, CropType::Lettuce, CropType::Corn, CropType::Potato }) {
+        int t = nearestTarget(s, TargetKind::Grown, c, from);
+        if (t < 0) continue;
+        sf::Vector2f d = tileCenter(t) - from;
+        float d2 = d.x * d.x + d.y * d.y;
+        if (d2 < bestD || (d2 == bestD && t < best)) { bestD = d2; best = t; }
+    }
+    return best;
+}
+
+// AI decision helper: choose a crop requested (highest remaining qty) or nearest seed if none
+CropType GameSim::chooseTargetCrop() const {
+    // highest qty remaining in the oldest open request
+    CropType best = orders.mostWanted();
+    if (best != CropType::None) return best;
+    // fallback: pick first crop that exists in seed boxes
+    for (CropType c : { CropType::Carrot, CropType::Tomato, CropType::Lettuce, CropType::Corn, CropType::Potato }) {
+        if (targets.count(TargetKind::Seeds, c) > 0) return c;
+    }
+    return CropType::None;
+}
+
+void GameSim::decideAgent(int a, float dt) {
+    const Side side = agents.side[a];
+    const sf::Vector2f aiPos = agents.position[a]; // where this step's walk brought the agent
+    const std::vector<int>& path = agents.path[a];
+    AIState& state = agents.state[a];
+    CropType& targetCrop = agents.targetCrop[a];
+
+    auto arrived = [&]() { return agents.pathIndex[a] >= static_cast<int>(path.size()); };
+
+    // State machine transitions & actions
+    switch (state) {
+        case AIState::SelectGoal: {
+            // sent back here while carrying something (another farmer finished the
+            // request, or its tile was taken): finish that first
+            if (agents.hasProduct[a]) {
+                state = headFor(a, TargetKind::Market, CropType::None, aiPos) ? AIState::GoToMarket : AIState::Idle;
+                break;
+            }
+            if (agents.hasSeed[a]) {
+                targetCrop = agents.carriedSeed[a];
+                int plantIdx = nearestTarget(side, TargetKind::EmptySoil, CropType::None, aiPos);
+                if (plantIdx >= 0) { requestPath(a, plantIdx); state = AIState::GoToPlant; }
+                else if (headFor(a, TargetKind::Trash, CropType::None, aiPos)) state = AIState::GoToTrash; // field full: drop the seed
+                else state = AIState::Idle;
+                break;
+            }
+            // no free soil on this side: harvest whatever is grown to make room, needed or not
+            if (nearestTarget(side, TargetKind::EmptySoil, CropType::None, aiPos) < 0) {
+                int grownIdx = nearestGrown(side, aiPos);
+                if (grownIdx >= 0) {
+                    targetCrop = grid.crop[grownIdx];
+                    requestPath(a, grownIdx);
+                    state = AIState::Harvest;
+                } else {
+                    state = AIState::Idle;
+                }
+                break;
+            }
+            targetCrop = chooseTargetCrop();
+            if (targetCrop == CropType::None) {
+                state = AIState::Idle;
+                break;
+            }
+            // head for the nearest seed tile for that crop on the agent's side
+            if (headFor(a, TargetKind::Seeds, targetCrop, aiPos)) {
+                state = AIState::GoToSeeds;
+            } else {
+                // no seeds available: idle for a moment
+                state = AIState::Idle;
+            }
+            break;
+        }
+
+        case AIState::GoToSeeds: {
+            if (path.empty()) {
+                // recompute path to nearest seed tile
+                if (!headFor(a, TargetKind::Seeds, targetCrop, aiPos)) state = AIState::SelectGoal;
+                break;
+            }
+            // (the path was followed in moveAgents)
+            // If close enough to final goal tile, simulate 'take seed' like player `T` does
+            if (arrived()) {
+                int finalTile = path.empty() ? -1 : path.back();
+                if (finalTile >= 0) {
+                    // perform take seed
+                    if (grid.type[finalTile] == GroundType::Seeds && !agents.hasSeed[a] && grid.crop[finalTile] == targetCrop) {
+                        agents.carriedSeed[a] = grid.crop[finalTile];
+                        agents.hasSeed[a] = 1;
+                        // optionally: leave the seed box as is (multiple seeds) or mark as taken
+                        publish(GameEventType::SeedTaken, side, a, finalTile, grid.crop[finalTile]);
+                        // seed-taken visual for AI taking a seed
+                        effects.spawn(EffectType::SeedTaken, finalTile, grid.crop[finalTile], seed_take_visual_temp);
+                        state = AIState::GoToPlant;
+                        // Choose planting spot: nearest soil empty tile
+                        int plantIdx = nearestTarget(side, TargetKind::EmptySoil, CropType::None, aiPos);
+                        if (plantIdx >= 0) requestPath(a, plantIdx);
+                        else state = AIState::Idle;
+                    } else {
+                        state = AIState::SelectGoal;
+                    }
+                } else {
+                    state = AIState::SelectGoal;
+                }
+            }
+            break;
+        }
+
+        case AIState::GoToPlant: {
+            if (path.empty()) {
+                // no available planting tile: return to select
+                state = AIState::SelectGoal;
+                break;
+            }
+            if (arrived()) {
+                // arrived at tile: plant if possible
+                int finalTile = path.empty() ? -1 : path.back();
+                if (finalTile >= 0 && agents.hasSeed[a] && grid.type[finalTile] == GroundType::Soil && grid.state[finalTile] == TileState::Empty) {
+                    grid.crop[finalTile] = agents.carriedSeed[a];
+                    setTileState(finalTile, TileState::Seeded);
+                    scheduleGrowth(finalTile);
+                    agents.hasSeed[a] = 0;
+                    agents.carriedSeed[a] = CropType::None;
+                    publish(GameEventType::Planted, side, a, finalTile, grid.crop[finalTile]);
+                    state = AIState::WaitForGrowth;
+                } else {
+                    state = AIState::SelectGoal;
+                }
+            }
+            break;
+        }
+
+        case AIState::WaitForGrowth: {
+            // look for any grown crop of targetCrop to harvest
+            int grownIdx = nearestTarget(side, TargetKind::Grown, targetCrop, aiPos);
+            if (grownIdx >= 0) {
+                requestPath(a, grownIdx);
+                state = AIState::Harvest;
+            } else {
+                // do nothing this frame; you might let the AI wander or idle
+                // we'll let it remain in WaitForGrowth and recheck next frame
+            }
+            break;
+        }
+
+        case AIState::Harvest: {
+            if (path.empty()) {
+                state = AIState::WaitForGrowth;
+                break;
+            }
+            if (arrived()) {
+                int finalTile = path.empty() ? -1 : path.back();
+                if (finalTile >= 0 && tileState(finalTile) == TileState::Grown) {
+                    // harvest - mimic player logic
+                    setTileState(finalTile, TileState::Empty);
+                    agents.carriedSeed[a] = grid.crop[finalTile];
+                    agents.hasProduct[a] = 1;
+                    publish(GameEventType::Harvested, side, a, finalTile, agents.carriedSeed[a]);
+                    // go to market
+                    state = headFor(a, TargetKind::Market, CropType::None, aiPos) ? AIState::GoToMarket : AIState::SelectGoal;
+                } else {
+                    state = AIState::WaitForGrowth;
+                }
+            }
+            break;
+        }
+
+        case AIState::GoToMarket: {
+            if (path.empty()) { state = AIState::SelectGoal; break; }
+            if (arrived()) {
+                int finalTile = path.empty() ? -1 : path.back();
+                if (finalTile >= 0 && grid.type[finalTile] == GroundType::Market && agents.hasProduct[a]) {
+                    deliver(side, a, finalTile, agents.carriedSeed[a]);
+                    agents.hasProduct[a] = 0;
+                    agents.carriedSeed[a] = CropType::None;
+                }
+                state = AIState::SelectGoal;
+            }
+            break;
+        }
+
+        case AIState::GoToTrash: {
+            if (path.empty()) { state = AIState::SelectGoal; break; }
+            if (arrived()) {
+                int finalTile = path.back();
+                if (grid.type[finalTile] == GroundType::Trash && agents.hasSeed[a]) {
+                    GameEvent e;
+                    e.type = GameEventType::Discarded;
+                    e.side = side;
+                    e.farmer = static_cast<std::int16_t>(a);
+                    e.tile = finalTile;
+                    e.crop = agents.carriedSeed[a];
+                    e.item = Item::Seed;
+                    publish(e);
+                    agents.hasSeed[a] = 0;
+                    agents.carriedSeed[a] = CropType::None;
+                }
+                state = AIState::SelectGoal;
+            }
+            break;
+        }
+
+        case AIState::Idle:
+        default: {
+            // every few seconds re-evaluate
+            agents.idleTimer[a] += dt;
+            if (agents.idleTimer[a] > 0.2f) {
+                agents.idleTimer[a] = 0.f;
+                state = AIState::SelectGoal;
+            }
+            break;
+        }
+    } // end switch
+}
+
+// Snapshots: fields are written one by one (no struct padding in the image) in a
+// fixed order, with the AI agents last since their paths change length.
+
+static void writeFarmer(ByteWriter& out, const Farmer& f) {
+    out.put(f.position.x); out.put(f.position.y);
+    out.put(f.prevPosition.x); out.put(f.prevPosition.y);
+    out.put(f.velocity.x); out.put(f.velocity.y);
+    out.put(f.radius);
+    std::uint8_t carry = (f.hasSeed ? 1 : 0) | (f.hasWater ? 2 : 0) | (f.hasSun ? 4 : 0) | (f.hasProduct ? 8 : 0);
+    out.put(carry);
+    out.put(f.carriedSeed);
+}
+
+static void readFarmer(ByteReader& in, Farmer& f) {
+    f.position.x = in.get<float>(); f.position.y = in.get<float>();
+    f.prevPosition.x = in.get<float>(); f.prevPosition.y = in.get<float>();
+    f.velocity.x = in.get<float>(); f.velocity.y = in.get<float>();
+    f.radius = in.get<float>();
+    std::uint8_t carry = in.get<std::uint8_t>();
+    f.hasSeed = carry & 1;
+    f.hasWater = carry & 2;
+    f.hasSun = carry & 4;
+    f.hasProduct = carry & 8;
+    f.carriedSeed = in.get<CropType>();
+}
+
+static void writeRequest(ByteWriter& out, const Request& r) {
+    out.put<std::int32_t>(r.id);
+    out.put(r.itemCount);
+    for (const Request::Item& item : r) {
+        out.put(item.crop);
+        out.put(item.remaining);
+        out.put(item.initial);
+        out.put(item.playerContrib);
+        out.put(item.aiContrib);
+    }
+}
+
+static bool readRequest(ByteReader& in, Request& r) {
+    r.id = in.get<std::int32_t>();
+    r.itemCount = in.get<std::uint8_t>();
+    if (!in.ok || r.itemCount > Request::maxItems) return false;
+    for (int i = 0; i < r.itemCount; ++i) {
+        Request::Item& item = r.items[i];
+        item.crop = in.get<CropType>();
+        if (static_cast<int>(item.crop) > static_cast<int>(CropType::Potato)) return false;
+        item.remaining = in.get<std::uint16_t>();
+        item.initial = in.get<std::uint16_t>();
+        item.playerContrib = in.get<std::uint16_t>();
+        item.aiContrib = in.get<std::uint16_t>();
+    }
+    return in.ok;
+}
+
+void GameSim::writeState(ByteWriter& out) const {
+    out.put(tick);
+    out.put(gameTimer);
+    out.put<std::uint8_t>(EndGame ? 1 : 0);
+    out.put(winner);
+
+    writeFarmer(out, playerFarmer);
+    out.put<std::int32_t>(playerScore);
+    out.put<std::int32_t>(aiScore);
+
+    out.put<std::int32_t>(playerRequestsCompleted);
+    out.put<std::int32_t>(aiRequestsCompleted);
+    out.put<std::int32_t>(playerCorrectDeliveries);
+    out.put<std::int32_t>(aiCorrectDeliveries);
+
+    const OrderBook::Totals& retired = orders.getRetired();
+    out.put<std::int32_t>(retired.requests);
+    out.put<std::int32_t>(retired.units);
+    out.put<std::int32_t>(retired.playerUnits);
+    out.put<std::int32_t>(retired.aiUnits);
+    out.put<std::int32_t>(orders.getGenerated());
+    out.putVarint(static_cast<std::uint32_t>(orders.getOpenCount()));
+    orders.forEachOpen([&out](const Request& r) { writeRequest(out, r); });
+    out.putVarint(static_cast<std::uint32_t>(orders.getUpcomingCount()));
+    for (int i = 0; i < orders.getUpcomingCount(); ++i) writeRequest(out, orders.getUpcoming(i));
+
+    out.put<std::uint8_t>(static_cast<std::uint8_t>(effects.size()));
+    for (const TileEffect& e : effects) {
+        out.put<std::int32_t>(e.tile);
+        out.put(e.timeLeft);
+        out.put(e.duration);
+        out.put(e.crop);
+        out.put(e.type);
+    }
+
+    out.putVarint(static_cast<std::uint32_t>(agents.size()));
+    for (int a = 0; a < agents.size(); ++a) {
+        out.put(agents.position[a].x); out.put(agents.position[a].y);
+        out.put(agents.prevPosition[a].x); out.put(agents.prevPosition[a].y);
+        out.put(agents.radius[a]);
+        out.put(agents.side[a]);
+        out.put<std::uint8_t>((agents.hasSeed[a] ? 1 : 0) | (agents.hasProduct[a] ? 8 : 0));
+        out.put(agents.carriedSeed[a]);
+        out.put(agents.state[a]);
+        out.put(agents.targetCrop[a]);
+        out.put(agents.bounceDir[a]);
+        out.put(agents.idleTimer[a]);
+        out.put<std::int32_t>(agents.pathIndex[a]);
+        out.putVarint(static_cast<std::uint32_t>(agents.path[a].size()));
+        for (int t : agents.path[a]) out.put<std::int32_t>(t);
+    }
+}
+
+// Read through a state image like readState without applying it (keep the two in step
+// with writeState): false if it's cut short or holds counts, crops or tiles this match
+// can't have
+bool GameSim::checkState(ByteReader in) const {
+    in.get<std::uint32_t>();
+    in.get<float>();
+    in.get<std::uint8_t>();
+    in.get<Winner>();
+    Farmer farmer;
+    readFarmer(in, farmer);
+    for (int i = 0; i < 11; ++i) in.get<std::int32_t>(); // scores, completed and correct counts, retired totals, generated
+
+    Request r;
+    const std::uint32_t openCount = in.getVarint();
+    if (!in.ok || openCount > static_cast<std::uint32_t>(orders.getOpenLimit())) return false;
+    for (std::uint32_t i = 0; i < openCount; ++i) {
+        if (!readRequest(in, r)) return false;
+    }
+    const std::uint32_t upcomingCount = in.getVarint();
+    if (!in.ok || upcomingCount > static_cast<std::uint32_t>(orders.getLookAhead())) return false;
+    for (std::uint32_t i = 0; i < upcomingCount; ++i) {
+        if (!readRequest(in, r)) return false;
+    }
+
+    const int effectCount = in.get<std::uint8_t>();
+    for (int i = 0; i < effectCount; ++i) {
+        const int tile = in.get<std::int32_t>();
+        if (tile < 0 || tile >= grid.size()) return false;
+        in.get<float>();
+        in.get<float>();
+        in.get<CropType>();
+        in.get<EffectType>();
+    }
+
+    if (in.getVarint() != static_cast<std::uint32_t>(agents.size()) || !in.ok) return false;
+    for (int a = 0; a < agents.size() && in.ok; ++a) {
+        for (int i = 0; i < 5; ++i) in.get<float>(); // position, previous position, radius
+        in.get<Side>();
+        in.get<std::uint8_t>();
+        in.get<CropType>();
+        in.get<AIState>();
+        in.get<CropType>();
+        in.get<float>();
+        in.get<float>();
+        const int pathIndex = in.get<std::int32_t>();
+        const std::uint32_t pathLength = in.getVarint();
+        if (pathIndex < 0 || pathLength > static_cast<std::uint32_t>(grid.size())) return false;
+        for (std::uint32_t i = 0; i < pathLength; ++i) {
+            const int tile = in.get<std::int32_t>();
+            if (tile < 0 || tile >= grid.size()) return false;
+        }
+    }
+    return in.ok;
+}
+
+bool GameSim::readState(ByteReader& in) {
+    // nothing is written unless all of it can be read
+    if (!checkState(in)) return false;
+
+    tick = in.get<std::uint32_t>();
+    gameTimer = in.get<float>();
+    EndGame = in.get<std::uint8_t>() != 0;
+    winner = in.get<Winner>();
+
+    readFarmer(in, playerFarmer);
+    playerScore = in.get<std::int32_t>();
+    aiScore = in.get<std::int32_t>();
+
+    playerRequestsCompleted = in.get<std::int32_t>();
+    aiRequestsCompleted = in.get<std::int32_t>();
+    playerCorrectDeliveries = in.get<std::int32_t>();
+    aiCorrectDeliveries = in.get<std::int32_t>();
+
+    OrderBook::Totals retired;
+    retired.requests = in.get<std::int32_t>();
+    retired.units = in.get<std::int32_t>();
+    retired.playerUnits = in.get<std::int32_t>();
+    retired.aiUnits = in.get<std::int32_t>();
+    int generated = in.get<std::int32_t>();
+    std::vector<Request> open(in.getVarint());
+    for (Request& r : open) {
+        if (!readRequest(in, r)) return false;
+    }
+    std::vector<Request> upcoming(in.getVarint());
+    for (Request& r : upcoming) {
+        if (!readRequest(in, r)) return false;
+    }
+    if (!in.ok) return false;
+    orders.restore(retired, generated, open, upcoming);
+
+    effects.clear();
+    int effectCount = in.get<std::uint8_t>();
+    for (int i = 0; i < effectCount; ++i) {
+        TileEffect e;
+        e.tile = in.get<std::int32_t>();
+        e.timeLeft = in.get<float>();
+        e.duration = in.get<float>();
+        e.crop = in.get<CropType>();
+        e.type = in.get<EffectType>();
+        effects.restore(e);
+    }
+
+    // the number of agents is fixed for a match
+    if (in.getVarint() != static_cast<std::uint32_t>(agents.size()) || !in.ok) return false;
+    for (int a = 0; a < agents.size() && in.ok; ++a) {
+        agents.position[a].x = in.get<float>(); agents.position[a].y = in.get<float>();
+        agents.prevPosition[a].x = in.get<float>(); agents.prevPosition[a].y = in.get<float>();
+        agents.radius[a] = in.get<float>();
+        agents.side[a] = in.get<Side>();
+        std::uint8_t carry = in.get<std::uint8_t>();
+        agents.hasSeed[a] = carry & 1;
+        agents.hasProduct[a] = (carry & 8) ? 1 : 0;
+        agents.carriedSeed[a] = in.get<CropType>();
+        agents.state[a] = in.get<AIState>();
+        agents.targetCrop[a] = in.get<CropType>();
+        agents.bounceDir[a] = in.get<float>();
+        agents.idleTimer[a] = in.get<float>();
+        agents.pathIndex[a] = in.get<std::int32_t>();
+        std::uint32_t pathLength = in.getVarint();
+        if (pathLength > static_cast<std::uint32_t>(grid.size())) return false;
+        agents.path[a].resize(pathLength);
+        for (int& t : agents.path[a]) t = in.get<std::int32_t>();
+    }
+    if (!in.ok) return false;
+
+    // derived data: growth timers and the AI target index come from the tiles
+    growthQueue = decltype(growthQueue)();
+    for (int i = 0; i < grid.size(); ++i) {
+        if (isGrowing(grid.state[i]) && grid.type[i] == GroundType::Soil) growthQueue.push({grid.readyTick[i], i});
+    }
+    targets.build(grid, layout.tileSize.x, layout.tileSize.y);
+    for (DStarLite& p : planners) p.clear();
+    walkChanges.clear();
+    return true;
+}
+
+void GameSim::writeTile(ByteWriter& out, int index) const {
+    out.put(grid.state[index]);
+    out.put(grid.crop[index]);
+    out.put(grid.walkable[index]);
+    out.put(grid.readyTick[index]);
+}
+
+bool GameSim::readTile(ByteReader& in, int index) {
+    if (index < 0 || index >= grid.size()) return false;
+    grid.state[index] = in.get<TileState>();
+    grid.crop[index] = in.get<CropType>();
+    std::uint8_t walkable = in.get<std::uint8_t>();
+    const bool changed = walkable != grid.walkable[index];
+    grid.walkable[index] = walkable;
+    if (changed) walkabilityChanged(index);
+    grid.readyTick[index] = in.get<std::uint32_t>();
+    return in.ok;
+}
@@ -0,0 +1,367 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+
+#include <queue>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "farmGrid.hpp"
+#include "effectPool.hpp"
+#include "targetIndex.hpp"
+#include "aiAgents.hpp"
+#include "jobSystem.hpp"
+#include "gameEvents.hpp"
+#include "orderBook.hpp"
+#include "gridPath.hpp"
+#include "flowField.hpp"
+#include "pathCache.hpp"
+#include "hierarchicalPath.hpp"
+#include "dStarLite.hpp"
+
+struct ByteWriter;
+struct ByteReader;
+
+// Render-free simulation core of a match (farm grid, farmers, requests, AI, timers, scoring).
+// Everything here is in logical play-area units with the origin at the top-left of the farm,
+// so a match can be stepped without a window. Game is the SFML view on top of it.
+
+enum class ActionType { None, Plant, Harvest, TakeSeed, TakeWater, TakeSun, DropWater, DropSun, DropProduct };
+
+// Player input for one simulation step
+struct PlayerInput {
+    sf::Vector2f move{0.f, 0.f}; // raw arrow-key direction
+    bool take = false;           // T pressed since the last step
+    bool drop = false;           // D pressed since the last step
+};
+
+// Duration for the temporary sold visual (seconds)
+static constexpr float sold_visual_temp = 0.8f;
+// Duration for the temporary seed-taken visual (seconds)
+static constexpr float seed_take_visual_temp = 0.6f;
+
+// The human farmer (AI farmers live in AIAgents)
+struct Farmer {
+    sf::Vector2f position{0.f, 0.f}; // centre, in play-area units
+    sf::Vector2f prevPosition{0.f, 0.f}; // position before the last step (for render interpolation)
+    float radius = 18.f;
+    sf::Vector2f velocity{0.f, 0.f};
+    bool hasSeed = false;
+    bool hasWater = false;
+    bool hasSun = false;
+    bool hasProduct = false;
+    CropType carriedSeed = CropType::None;
+};
+
+// Cached play-area metrics, rebuilt only when the grid changes (GameSim::recomputeLayout).
+// Hot-path queries read these instead of re-deriving tile sizes with divisions. Positions
+// are relative to the top-left of the farm; the view (Game) adds its own screen offset.
+struct GridLayout {
+    sf::Vector2f tileSize{0.f, 0.f}; // extent of one tile slot
+    sf::Vector2f invTileSize{0.f, 0.f}; // 1 / tileSize
+    float playWidth = 0.f;
+    float playHeight = 0.f;
+    float wallLeft = 0.f;  // divider between the player (left) and AI (right) sides
+    float wallRight = 0.f;
+    int wallCol = 0;       // first column on the AI side of the divider
+    int playerCols = 0;    // columns on the player side of the divider (0 .. playerCols-1)
+};
+
+// Per-match overrides of the level tables, for balancing runs (0 keeps the level's value)
+struct MatchRules {
+    float matchSeconds = 0.f; // initialTimeForLevel
+    int numRequests = 0;      // numRequestsForLevel
+    int maxQty = 0;           // maxQtyForLevel
+    bool log = true;          // print the requests to std::cout (match events: getEvents)
+    int aiFarmers = 1;        // AI farmers on the AI (right) side
+    int aiHelpers = 0;        // AI farmers helping the player on the left side
+    int openRequests = 0;     // requests open at the same time (0: one after the other)
+    bool endless = false;     // requests never run out (the timer still ends the match)
+    PathAlgorithm pathAlgorithm = PathAlgorithm::AStar; // how AI farmers find their way
+    bool flowFields = true;   // walk to seed boxes, markets and trash along flow fields (false: search a path each time)
+    int pathCacheSize = 256;  // path search results remembered for repeated trips (0: none)
+    bool smoothPaths = true;  // walk straight past path tiles where nothing is in the way (false: tile centre to tile centre)
+};
+
+class GameSim {
+public:
+    // Logical size of one tile (the original 12x6 farm on the 960x490 play area)
+    static constexpr float tileWidth = 80.f;
+    static constexpr float tileHeight = 490.f / 6.f;
+    // Largest grid side a level file may declare
+    static constexpr int maxGridSize = 1024;
+
+    // The sim always advances in fixed steps so results never depend on the frame rate
+    static constexpr float fixedStep = 1.f / 120.f;
+
+    // The seed drives every random choice of the match (requests); same level, seed and
+    // inputs give the same match
+    explicit GameSim(int levelID = 1, std::uint32_t seed = randomSeed(), const MatchRules& rules = MatchRules());
+    static std::uint32_t randomSeed();
+    std::uint32_t getSeed() const { return seed; }
+
+    // Advance the match by one fixedStep with the given player input
+    void step(const PlayerInput& input);
+    std::uint32_t getTick() const { return tick; }
+
+    // Run the per-agent phases of each step on this pool (nullptr: all on the calling
+    // thread). The result of a step is the same either way.
+    void setJobSystem(JobSystem* js) { jobs = js; }
+
+    // Search used for the AI farmers' paths from now on (starts as rules.pathAlgorithm)
+    void setPathAlgorithm(PathAlgorithm a) { pathAlgorithm = a; pathCache.clear(); }
+    PathAlgorithm getPathAlgorithm() const { return pathAlgorithm; }
+    // Hits, misses and search time of the AI's path cache so far
+    PathCache::Stats getPathCacheStats() const { return pathCache.getStats(); }
+
+    void setPlayerSpeed(float s) { playerSpeed = s; }
+    float getPlayerSpeed() const { return playerSpeed; }
+
+    // Grid
+    int getGridCols() const { return gridCols; }
+    int getGridRows() const { return gridRows; }
+    const FarmGrid& getGrid() const { return grid; }
+    bool isLevelLoaded() const { return levelLoaded; }
+    // Block or free a tile; the AI's flow fields are rebuilt at the start of the next step
+    void setTileWalkable(int index, bool walkable);
+    // Goes up whenever any tile's walkability changes
+    std::uint32_t getWalkabilityVersion() const { return walkVersion; }
+
+    // Live sold / seed-taken visuals
+    const EffectPool& getEffects() const { return effects; }
+
+    // Logical play area and the divider between the two sides
+    float getPlayWidth() const { return layout.playWidth; }
+    float getPlayHeight() const { return layout.playHeight; }
+    float getWallLeft() const { return layout.wallLeft; }
+    float getWallRight() const { return layout.wallRight; }
+    const GridLayout& getLayout() const { return layout; }
+
+    // Farmers
+    const Farmer& getPlayer() const { return playerFarmer; }
+    const AIAgents& getAgents() const { return agents; }
+
+    // Requests and scoring (per side: the player's side includes its AI helpers)
+    int getPlayerScore() const { return playerScore; }
+    int getAIScore() const { return aiScore; }
+    const OrderBook& getOrders() const { return orders; }
+    // Number of the oldest open request (the number generated if none is open)
+    int getCurrentRequestIndex() const { return orders.getFirstOpen(); }
+    int getLevelID() const { return levelID; }
+    int getPlayerRequestsCompleted() const { return playerRequestsCompleted; }
+    int getAIRequestsCompleted() const { return aiRequestsCompleted; }
+    int getPlayerCorrectDeliveries() const { return playerCorrectDeliveries; }
+    int getAICorrectDeliveries() const { return aiCorrectDeliveries; }
+
+    // What happened during the steps so far (taken, planted, delivered, completed...);
+    // the view drains it once per frame. Not part of snapshots.
+    EventQueue& getEvents() { return events; }
+
+    // Match timer / end of game
+    float getTimeLeft() const { return gameTimer; }
+    bool isGameOver() const { return EndGame; }
+    Winner getWinner() const { return winner; }
+    void decideWinnerOnGameEnd();
+
+    int numRequestsForLevel(int level) const;
+    std::string requestToString(const Request& r) const;
+    static const char* cropName(CropType c);
+
+    int tileIndexFromPos(const sf::Vector2f& pos) const;
+    sf::Vector2f tileCenter(int index) const;
+
+    // Growth state of a tile, derived from its ready tick (valid between steps too)
+    TileState tileState(int index) const;
+
+    // Snapshots (see snapshot.hpp). The match is saved in two parts: the tiles, and
+    // everything else ("state"). readState must come after the tiles are in place,
+    // it rebuilds the growth queue and target index from them.
+    // readState checks the whole image first and leaves the sim as it was if it fails;
+    // checkState is that check on its own.
+    void writeState(ByteWriter& out) const;
+    bool readState(ByteReader& in);
+    bool checkState(ByteReader in) const;
+    void writeTile(ByteWriter& out, int index) const;
+    bool readTile(ByteReader& in, int index);
+    static constexpr std::size_t tileSnapshotBytes = 7;
+
+    // Tiles changed since the last clearDirtyTiles (so a snapshot can store only those)
+    const std::vector<int>& getDirtyTiles() const { return dirtyTiles; }
+    void clearDirtyTiles();
+
+private:
+    // Core
+    float playerSpeed = 200.f;
+    std::uint32_t tick = 0; // number of steps taken so far
+    int levelID = 1;
+    bool levelLoaded = false;
+    std::uint32_t seed = 0;
+    std::mt19937 rng;
+    MatchRules rules;
+    PathAlgorithm pathAlgorithm;
+    JobSystem* jobs = nullptr;
+    JobGraph stepJobs; // the phases of update, built on first use
+    const GameSim* stepJobsOwner = nullptr;
+    float stepDt = 0.f;
+
+    // Play area (sized from the grid)
+    GridLayout layout;
+
+    // Farm grid (12x6 unless the level file says otherwise)
+    FarmGrid grid;
+    int gridCols = 12;
+    int gridRows = 6;
+
+    // Seed boxes, market, empty soil and grown crops, for the AI's nearest-tile queries
+    TargetIndex targets;
+
+    // Flow fields toward the tiles that never change: per side, the markets, the trash
+    // and the seed boxes of each crop. Rebuilt at the start of a step when walkability
+    // (or whether the path search moves diagonally) changed since they were built.
+    static constexpr int flowTargets = 7;
+    std::array<FlowField, 2 * flowTargets> flowFields;
+    std::uint32_t walkVersion = 1;
+    std::uint32_t flowVersion = 0; // walkVersion the fields were built for
+    void refreshFlowFields();
+    static int flowSlot(Side s, TargetKind kind, CropType crop);
+
+    // Per tile, the connected area of its side's open tiles it belongs to (-1 if blocked
+    // or outside both sides), so nearest-tile queries skip targets walled off from the
+    // asker. Relabelled at the start of a step when walkability changed.
+    std::vector<int> areaOf;
+    std::vector<int> areaQueue; // labelling scratch, reserved to grid size
+    std::uint32_t areaVersion = 0;
+    void refreshAreas();
+    // Change a tile's state and keep the target index in step
+    void setTileState(int index, TileState s);
+    void markTileDirty(int index);
+    std::vector<std::uint8_t> tileDirty;
+    std::vector<int> dirtyTiles;
+
+    EffectPool effects;
+
+    EventQueue events;
+    void publish(GameEvent e); // stamps the current tick
+    void publish(GameEventType type, Side side, int farmer, int tile, CropType crop);
+    void publishMatchEnded();
+
+    // Farmers
+    Farmer playerFarmer;
+    AIAgents agents;
+    void spawnAgents(Side s, int count);
+
+    int playerScore = 0;
+    int aiScore = 0;
+
+    // Match timer
+    float gameTimer = 0.f; //set in constructor
+    float initialTimeForLevel(int level) const;
+
+    bool EndGame {false};
+    Winner winner {Winner::None};
+
+    // Requests / Orders
+    OrderBook orders;
+    static constexpr int endlessLookAhead = 4; // requests generated ahead in endless mode
+    void refillOrders();
+
+    // Counters for how many whole requests each side completed
+    int playerRequestsCompleted = 0;
+    int aiRequestsCompleted = 0;
+    // Total number of correct deliveries (useful veg delivered) by each side
+    int playerCorrectDeliveries = 0;
+    int aiCorrectDeliveries = 0;
+
+    // Request helpers
+    std::vector<CropType> allowedCropsForLevel(int level) const;
+    int maxQtyForLevel(int level) const;
+    Request makeRandomRequest(int level);
+    int randomInt(int lo, int hi);
+
+    void loadLevel();
+    void recomputeLayout();
+
+    // Crop growth: planted tiles store the tick they will be grown at, and a min-heap
+    // of (readyTick, tile) hands out only the tiles that actually become grown.
+    // Watering or sunning re-plants the timer; the older heap entry is then stale.
+    static constexpr float growSeconds = 3.f;
+    std::priority_queue<std::pair<std::uint32_t, int>,
+        std::vector<std::pair<std::uint32_t, int>>, std::greater<>> growthQueue;
+    void scheduleGrowth(int index);
+    void processGrowth();
+    static bool isGrowing(TileState s) { return s == TileState::Seeded || s == TileState::Watered || s == TileState::Suned; }
+
+    // AI-related members (per-agent state is in agents)
+    float aiMaxSpeed = 175.f; // AI movement speed
+    float aiArriveThreshold = 10.f; // units to consider 'arrived' at a waypoint
+
+    // A step runs in phases: agents [begin, end) walk (parallel, each agent only touches
+    // its own entries), the world ticks (growth, effects, timer; alongside the walking),
+    // every agent decides in index order (serial, they share tiles and requests), then
+    // the paths asked for are searched (parallel again).
+    void update(float dt, sf::Vector2f playerDir);
+    void moveAgents(int begin, int end, float dt);
+    void updateWorld(float dt);
+    void decideAgent(int a, float dt);
+    void solvePaths(int begin, int end);
+    static constexpr int agentsPerJob = 8;
+
+    void requestPath(int a, int tileIdx) { agents.pathRequest[a] = tileIdx; }
+    // Send agent a to the nearest seed box of crop / market / trash on its side: along the
+    // flow field, or with a path search to the nearest tile. False if there's none.
+    bool headFor(int a, TargetKind kind, CropType crop, const sf::Vector2f& from);
+    void setAgentPathToTile(int a, int tileIdx, const sf::Vector2f& from);
+    bool searchAgentPath(int a, int start, int goal);
+    void moveAgentAlongPath(int a, float dt);
+    CropType chooseTargetCrop() const;
+
+    // Player interactions with the tile under the player (T = take, D = drop)
+    void playerTake();
+    void playerDrop();
+    // Score a product handed in at a market by the player (farmer -1) or AI agent farmer
+    void deliver(Side side, int farmer, int marketTile, CropType product);
+
+    // Grid helpers
+    bool tileContains(int index, const sf::Vector2f& p) const;
+    bool isTileWalkable(int index) const;
+    bool insidePlayArea(const sf::Vector2f& centre, float r) const;
+    // Whole circle on its own side of the divider
+    bool onSide(Side s, const sf::Vector2f& centre, float r) const;
+    // Columns [sideMinCol, sideEndCol) a farmer of that side may path through
+    int sideMinCol(Side s) const { return s == Side::AI ? layout.wallCol : 0; }
+    int sideEndCol(Side s) const { return s == Side::AI ? gridCols : layout.playerCols; }
+    int nearestTarget(Side s, TargetKind kind, CropType crop, const sf::Vector2f& from) const;
+    int nearestGrown(Side s, const sf::Vector2f& from) const;
+
+    // Pathfinding for AI (see gridPath.hpp), restricted to one side of the divider.
+    // Results are cached per walkability version (searched from the parallel path phase).
+    bool findPath(int startIdx, int goalIdx, Side side, std::vector<int>& path) const;
+    PathGrid sideGrid(Side side) const;
+    mutable PathCache pathCache;
+    // Each side's open tiles packed into bits for the A* inner loop, built with the layout
+    // and updated with every walkability change
+    std::array<WalkBits, 2> walkBits;
+    void walkabilityChanged(int index);
+    // Cluster graphs of the two sides for PathAlgorithm::Hierarchical, built on the first
+    // step that uses it and updated where tiles changed at the start of every step
+    std::array<HierarchicalPaths, 2> hierarchy;
+    void refreshHierarchy();
+    // PathAlgorithm::DStarLite: every agent's planner keeps the search of its current path.
+    // Tiles whose walkability changed are handed to the planners at the start of a step,
+    // and the paths they cross are repaired in the path phase. Not part of snapshots
+    // (after a restore the next change is a fresh search).
+    std::vector<DStarLite> planners;
+    std::vector<int> walkChanges; // tiles changed since the last step
+    void repairPlans();
+    // MatchRules::smoothPaths: agent a's new path is cut down to the corners of straight
+    // segments, kept far enough from blocked tiles that a farmer arriving anywhere near a
+    // corner can walk the next one
+    void smoothAgentPath(int a);
+};
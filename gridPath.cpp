@@ -0,0 +1,482 @@
+#include "gridPath.hpp"
+#include <limits>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <functional>
+
+const char* pathAlgorithmName(PathAlgorithm a) {
+    switch (a) {
+        case PathAlgorithm::AStar:      return "astar";
+        case PathAlgorithm::AStar8:     return "astar8";
+        case PathAlgorithm::JumpPoint:  return "jps";
+        case PathAlgorithm::JumpPoint8: return "jps8";
+        case PathAlgorithm::Hierarchical: return "hpa";
+        case PathAlgorithm::DStarLite:  return "dstar";
+    }
+    return "?";
+}
+
+bool parsePathAlgorithm(const std::string& name, PathAlgorithm& out) {
+    for (PathAlgorithm a : { PathAlgorithm::AStar, PathAlgorithm::AStar8, PathAlgorithm::JumpPoint, PathAlgorithm::JumpPoint8,
+                             PathAlgorithm::Hierarchical, PathAlgorithm::DStarLite }) {
+        if (name == pathAlgorithmName(a)) { out = a; return true; }
+    }
+    return false;
+}
+
+bool isDiagonal(PathAlgorithm a) {
+    return a == PathAlgorithm::AStar8 || a == PathAlgorithm::JumpPoint8;
+}
+
+void WalkBits::build(const PathGrid& grid) {
+    cols = grid.cols;
+    rows = grid.rows;
+    stride = cols + 2;
+    words.assign((static_cast<std::size_t>(getCellCount()) + 63) / 64, 0);
+    for (int tile = 0; tile < cols * rows; ++tile) update(grid, tile);
+}
+
+void WalkBits::update(const PathGrid& grid, int tile) {
+    const std::size_t cell = static_cast<std::size_t>(cellOf(tile));
+    const std::uint64_t bit = std::uint64_t(1) << (cell & 63);
+    if (grid.open(tile % cols, tile / cols)) words[cell >> 6] |= bit;
+    else words[cell >> 6] &= ~bit;
+}
+
+std::uint64_t WalkBits::after(int cell) const {
+    if (cell < 0) return cell > -64 ? after(0) << -cell : 0;
+    const std::size_t w = static_cast<std::size_t>(cell) >> 6;
+    const int b = cell & 63;
+    if (w >= words.size()) return 0;
+    std::uint64_t v = words[w] >> b;
+    if (b && w + 1 < words.size()) v |= words[w + 1] << (64 - b);
+    return v;
+}
+
+std::uint64_t WalkBits::before(int cell) const {
+    return after(cell - 63);
+}
+
+namespace {
+
+// Cost of the straight or diagonal line between two tiles (octile distance); with
+// diagonal off this is the Manhattan distance
+int distance(int ax, int ay, int bx, int by, bool diagonal) {
+    int dx = std::abs(ax - bx);
+    int dy = std::abs(ay - by);
+    if (!diagonal) return straightCost * (dx + dy);
+    return straightCost * (dx + dy) + (diagonalCost - 2 * straightCost) * std::min(dx, dy);
+}
+
+int sign(int v) { return (v > 0) - (v < 0); }
+
+// What A* keeps per cell. A record belongs to the search whose generation it carries;
+// older ones read as untouched, so nothing is cleared between searches.
+struct SearchNode {
+    int g = 0;
+    int from = -1;
+    std::uint32_t generation = 0;
+    bool closed = false;
+};
+
+// One thread's A* memory, reused by every search on it: after the first searches on a
+// grid (and paths as long as the ones asked for) a search allocates nothing
+class SearchScratch {
+public:
+    // Start a search over cells [0, count)
+    void begin(int count) {
+        if (static_cast<int>(nodes.size()) < count) nodes.resize(static_cast<std::size_t>(count));
+        if (++generation == 0) {
+            // wrapped around: old records could pass for new ones
+            for (SearchNode& n : nodes) n.generation = 0;
+            generation = 1;
+        }
+        heap.clear();
+    }
+
+    SearchNode& node(int cell) {
+        SearchNode& n = nodes[static_cast<std::size_t>(cell)];
+        if (n.generation != generation) {
+            n.g = std::numeric_limits<int>::max();
+            n.from = -1;
+            n.generation = generation;
+            n.closed = false;
+        }
+        return n;
+    }
+
+    // Open list: binary min-heap of (f, cell), smallest f (then cell) on top
+    bool empty() const { return heap.empty(); }
+    void push(int f, int cell) {
+        heap.push_back({f, cell});
+        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+    }
+    int pop() {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        const int cell = heap.back().second;
+        heap.pop_back();
+        return cell;
+    }
+
+    WalkBits packed; // for grids that come without their bits
+
+private:
+    std::vector<SearchNode> nodes;
+    std::vector<std::pair<int, int>> heap;
+    std::uint32_t generation = 0;
+};
+
+thread_local SearchScratch scratch;
+
+// Plain A* over the cells of a WalkBits (the grid's own, or packed into the scratch for
+// this search): the neighbours of every expanded cell go on the open list. Cells keep
+// the order of tiles, so ties on the open list break the same way as they would on tiles.
+bool searchAStar(const PathGrid& g, int start, int goal, bool diagonal, std::vector<int>& path, PathStats* stats) {
+    SearchScratch& sc = scratch;
+    if (!g.bits) sc.packed.build(g);
+    const WalkBits& bits = g.bits ? *g.bits : sc.packed;
+
+    const int W = bits.getStride();
+    const int s = bits.cellOf(start), t = bits.cellOf(goal);
+    const int gx = t % W, gy = t / W;
+
+    sc.begin(bits.getCellCount());
+    sc.node(s).g = 0;
+    sc.push(distance(s % W, s / W, gx, gy, diagonal), s);
+
+    // neighbours: 4 straight, then the diagonals; a diagonal also needs the straight
+    // steps on either side of it open (no corner cutting)
+    const int step[8] = {1, -1, W, -W, W + 1, W - 1, -W + 1, -W - 1};
+    const int alongX[8] = {0, 0, 0, 0, 1, -1, 1, -1};
+    const int alongY[8] = {0, 0, 0, 0, W, W, -W, -W};
+    const int dirs = diagonal ? 8 : 4;
+
+    while (!sc.empty()) {
+        const int current = sc.pop();
+        SearchNode& cur = sc.node(current);
+        if (cur.closed) continue;
+        if (current == t) {
+            for (int c = current; c != -1; c = sc.node(c).from) path.push_back(bits.tileOf(c));
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+        cur.closed = true;
+        if (stats) stats->expanded++;
+
+        for (int k = 0; k < dirs; ++k) {
+            const int n = current + step[k];
+            if (!bits.open(n)) continue;
+            if (k >= 4 && (!bits.open(current + alongX[k]) || !bits.open(current + alongY[k]))) continue;
+
+            const int tentativeG = cur.g + (k >= 4 ? diagonalCost : straightCost);
+            SearchNode& next = sc.node(n);
+            if (tentativeG < next.g) {
+                next.from = current;
+                next.g = tentativeG;
+                sc.push(tentativeG + distance(n % W, n / W, gx, gy, diagonal), n);
+            }
+        }
+    }
+    return false;
+}
+
+// Jump Point Search. Only tiles where an optimal path may have to turn (jump points) go
+// on the open list; the straight runs between them are scanned without touching it.
+// 4 directions: a turn from horizontal to vertical is only needed where the tile behind
+// the turn is blocked (otherwise turning one column earlier is just as short), so
+// horizontal runs stop at such tiles, and vertical runs stop wherever a horizontal run
+// from them would.
+// 8 directions (no corner cutting): the usual JPS rules, diagonal runs stop wherever a
+// straight run from them would.
+// Works on WalkBits cells in the same scratch memory as A*. Horizontal runs, which the
+// vertical and diagonal runs start from every tile they pass, test 63 tiles at a time on
+// the packed rows.
+class JumpPointSearch {
+public:
+    JumpPointSearch(const WalkBits& bits, int goal, bool diagonal, PathStats* stats)
+        : bits(bits), W(bits.getStride()), goal(bits.cellOf(goal)), diagonal(diagonal), stats(stats) {}
+
+    bool run(int start, std::vector<int>& path) {
+        SearchScratch& sc = scratch;
+        const int s = bits.cellOf(start);
+        const int gx = goal % W, gy = goal / W;
+
+        sc.begin(bits.getCellCount());
+        sc.node(s).g = 0;
+        sc.push(distance(s % W, s / W, gx, gy, diagonal), s);
+
+        while (!sc.empty()) {
+            const int current = sc.pop();
+            SearchNode& cur = sc.node(current);
+            if (cur.closed) continue;
+            if (current == goal) {
+                expand(current, path);
+                return true;
+            }
+            cur.closed = true;
+            if (stats) stats->expanded++;
+
+            const int cx = current % W, cy = current / W;
+            int dirs[8][2];
+            const int count = successors(current, cur.from, dirs);
+            for (int k = 0; k < count; ++k) {
+                const int jp = jump(current, dirs[k][0], dirs[k][1]);
+                if (jp < 0) continue;
+                SearchNode& next = sc.node(jp);
+                if (next.closed) continue;
+                const int jx = jp % W, jy = jp / W;
+                const int tentativeG = cur.g + distance(cx, cy, jx, jy, diagonal);
+                if (tentativeG < next.g) {
+                    next.from = current;
+                    next.g = tentativeG;
+                    sc.push(tentativeG + distance(jx, jy, gx, gy, diagonal), jp);
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    const WalkBits& bits;
+    const int W; // cells per row
+    const int goal;
+    const bool diagonal;
+    PathStats* stats;
+
+    bool open(int cell) const { return bits.open(cell); }
+
+    // Directions worth jumping in from cell n, given the jump point the search came from
+    int successors(int n, int from, int (&dirs)[8][2]) const {
+        int count = 0;
+        auto add = [&](int dx, int dy) { dirs[count][0] = dx; dirs[count][1] = dy; count++; };
+
+        if (from < 0) {
+            add(1, 0); add(-1, 0); add(0, 1); add(0, -1);
+            if (diagonal) {
+                for (int dy : {1, -1}) {
+                    for (int dx : {1, -1}) {
+                        if (open(n + dx) && open(n + dy * W)) add(dx, dy);
+                    }
+                }
+            }
+            return count;
+        }
+        const int dx = sign(n % W - from % W);
+        const int dy = sign(n / W - from / W);
+
+        if (!diagonal) {
+            if (dx != 0) {
+                add(dx, 0);
+                for (int s : {1, -1}) {
+                    if (open(n + s * W) && !open(n - dx + s * W)) add(0, s);
+                }
+            } else {
+                add(0, dy); add(1, 0); add(-1, 0);
+            }
+            return count;
+        }
+
+        if (dx != 0 && dy != 0) {
+            add(dx, 0);
+            add(0, dy);
+            if (open(n + dx) && open(n + dy * W)) add(dx, dy);
+        } else if (dx != 0) {
+            add(dx, 0);
+            for (int s : {1, -1}) {
+                if (!open(n + s * W)) continue;
+                add(0, s);
+                if (open(n + dx)) add(dx, s);
+            }
+        } else {
+            add(0, dy);
+            for (int s : {1, -1}) {
+                if (!open(n + s)) continue;
+                add(s, 0);
+                if (open(n + dy * W)) add(s, dy);
+            }
+        }
+        return count;
+    }
+
+    // Next jump point from cell c in direction (dx, dy), -1 if the run hits a wall
+    int jump(int c, int dx, int dy) {
+        if (dy == 0) return jumpAlongRow(c, dx);
+        const int step = dx + dy * W;
+        for (;;) {
+            if (dx != 0 && !(open(c + dx) && open(c + dy * W))) return -1; // corner
+            c += step;
+            if (stats) stats->scanned++;
+            if (!open(c)) return -1;
+            if (c == goal) return c;
+
+            if (dx != 0) {
+                if (jump(c, dx, 0) >= 0 || jump(c, 0, dy) >= 0) return c;
+            } else if (diagonal) {
+                // a vertical run stops at a tile with a neighbour that only a turn here reaches
+                if ((open(c - 1) && !open(c - 1 - dy * W)) || (open(c + 1) && !open(c + 1 - dy * W))) return c;
+            } else {
+                if (jump(c, 1, 0) >= 0 || jump(c, -1, 0) >= 0) return c;
+            }
+        }
+    }
+
+    // jump() along the row: the run stops at the first tile that is blocked, the goal, or
+    // has an open tile above or below whose neighbour behind it is blocked. Each round
+    // tests the 63 tiles after the window's first one (the tile the run is on) at once.
+    int jumpAlongRow(int c, int dx) {
+        const std::uint64_t first = std::uint64_t(1) << (dx > 0 ? 0 : 63);
+        for (int base = c;; base += 63 * dx) {
+            const std::uint64_t row = dx > 0 ? bits.after(base) : bits.before(base);
+            const std::uint64_t up = dx > 0 ? bits.after(base - W) : bits.before(base - W);
+            const std::uint64_t down = dx > 0 ? bits.after(base + W) : bits.before(base + W);
+            std::uint64_t stop = dx > 0 ? ~row | (up & ~(up << 1)) | (down & ~(down << 1))
+                                        : ~row | (up & ~(up >> 1)) | (down & ~(down >> 1));
+            const int toGoal = (goal - base) * dx;
+            if (toGoal > 0 && toGoal < 64) stop |= dx > 0 ? first << toGoal : first >> toGoal;
+            stop &= ~first;
+            if (!stop) continue;
+
+            const int bit = dx > 0 ? lowestBit(stop) : highestBit(stop);
+            const int n = base + (bit - (dx > 0 ? 0 : 63));
+            if (stats) stats->scanned += (n - c) * dx;
+            return (row >> bit) & 1u ? n : -1;
+        }
+    }
+
+    // Index of the lowest / highest set bit of v (v != 0): the bit alone, times a de Bruijn
+    // sequence, leaves a different pattern in the top 6 bits for each index
+    static int bitIndex(std::uint64_t single) {
+        static const int index[64] = {
+            0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+            62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+            63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+            46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6};
+        return index[(single * 0x03f79d71b4cb0a89ULL) >> 58];
+    }
+    static int lowestBit(std::uint64_t v) { return bitIndex(v & (~v + 1)); }
+    static int highestBit(std::uint64_t v) {
+        v |= v >> 1; v |= v >> 2; v |= v >> 4; v |= v >> 8; v |= v >> 16; v |= v >> 32;
+        return bitIndex(v ^ (v >> 1));
+    }
+
+    // Tiles from the start to cell end, the runs between the jump points filled in
+    void expand(int end, std::vector<int>& path) {
+        SearchScratch& sc = scratch;
+        int cur = end;
+        for (int prev = sc.node(cur).from; prev >= 0; cur = prev, prev = sc.node(cur).from) {
+            const int step = sign(cur % W - prev % W) + sign(cur / W - prev / W) * W;
+            for (int c = cur; c != prev; c -= step) path.push_back(bits.tileOf(c));
+        }
+        path.push_back(bits.tileOf(cur));
+        std::reverse(path.begin(), path.end());
+    }
+};
+
+} // namespace
+
+std::vector<int> findPath(PathAlgorithm algorithm, const PathGrid& grid, int start, int goal, PathStats* stats) {
+    std::vector<int> path;
+    findPath(algorithm, grid, start, goal, path, stats);
+    return path;
+}
+
+bool findPath(PathAlgorithm algorithm, const PathGrid& grid, int start, int goal, std::vector<int>& path, PathStats* stats) {
+    path.clear();
+    if (start < 0 || goal < 0) return false;
+    if (start == goal) {
+        path.push_back(start);
+        return true;
+    }
+
+    switch (algorithm) {
+        case PathAlgorithm::JumpPoint:
+        case PathAlgorithm::JumpPoint8:
+            if (!grid.bits) scratch.packed.build(grid);
+            return JumpPointSearch(grid.bits ? *grid.bits : scratch.packed, goal, isDiagonal(algorithm), stats).run(start, path);
+        case PathAlgorithm::AStar:
+        case PathAlgorithm::AStar8:
+        case PathAlgorithm::Hierarchical:
+        case PathAlgorithm::DStarLite:
+        default:
+            return searchAStar(grid, start, goal, isDiagonal(algorithm), path, stats);
+    }
+}
+
+int pathCost(const std::vector<int>& path, int cols) {
+    int cost = 0;
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        bool diagonalStep = path[i] % cols != path[i - 1] % cols && path[i] / cols != path[i - 1] / cols;
+        cost += diagonalStep ? diagonalCost : straightCost;
+    }
+    return cost;
+}
+
+namespace {
+
+// Every tile the segment from (x0, y0) to (x1, y1) touches (in tiles, the grid's own
+// corner at 0, 0) is open; through a corner, both tiles beside it must be
+bool segmentClear(const PathGrid& g, double x0, double y0, double x1, double y1) {
+    int x = static_cast<int>(std::floor(x0)), y = static_cast<int>(std::floor(y0));
+    const int ex = static_cast<int>(std::floor(x1)), ey = static_cast<int>(std::floor(y1));
+    if (!g.open(x, y)) return false;
+
+    // distance along the segment (0..1) to the next column / row boundary, and between them
+    const double dx = x1 - x0, dy = y1 - y0;
+    const int sx = dx > 0 ? 1 : -1, sy = dy > 0 ? 1 : -1;
+    const double inf = std::numeric_limits<double>::infinity();
+    const double deltaX = dx != 0 ? 1.0 / std::abs(dx) : inf;
+    const double deltaY = dy != 0 ? 1.0 / std::abs(dy) : inf;
+    double nextX = dx != 0 ? (sx > 0 ? x + 1 - x0 : x0 - x) * deltaX : inf;
+    double nextY = dy != 0 ? (sy > 0 ? y + 1 - y0 : y0 - y) * deltaY : inf;
+
+    const double eps = 1e-9;
+    for (int steps = std::abs(ex - x) + std::abs(ey - y); steps > 0 && (x != ex || y != ey); --steps) {
+        if (nextX < nextY - eps) {
+            x += sx;
+            nextX += deltaX;
+        } else if (nextY < nextX - eps) {
+            y += sy;
+            nextY += deltaY;
+        } else {
+            if (!g.open(x + sx, y) || !g.open(x, y + sy)) return false;
+            x += sx;
+            y += sy;
+            nextX += deltaX;
+            nextY += deltaY;
+            --steps;
+        }
+        if (!g.open(x, y)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool lineOfSight(const PathGrid& grid, int a, int b, float clearance) {
+    const double ax = a % grid.cols + 0.5, ay = a / grid.cols + 0.5;
+    const double bx = b % grid.cols + 0.5, by = b / grid.cols + 0.5;
+    const double len = std::hypot(bx - ax, by - ay);
+    const double r = std::min(static_cast<double>(clearance), 0.49);
+    if (len == 0 || r <= 0) return segmentClear(grid, ax, ay, bx, by);
+
+    // the two edges of the strip the walker sweeps; the ends stay inside tiles a and b,
+    // and no tile fits between the edges without touching one
+    const double nx = -(by - ay) / len * r, ny = (bx - ax) / len * r;
+    return segmentClear(grid, ax + nx, ay + ny, bx + nx, by + ny) &&
+           segmentClear(grid, ax - nx, ay - ny, bx - nx, by - ny);
+}
+
+void smoothPath(const PathGrid& grid, std::vector<int>& path, float clearance) {
+    if (path.size() < 3) return;
+    // greedy: keep a tile only where the next one can't be seen from the last tile kept
+    std::size_t kept = 1;
+    int from = path[0];
+    for (std::size_t i = 1; i + 1 < path.size(); ++i) {
+        if (lineOfSight(grid, from, path[i + 1], clearance)) continue;
+        from = path[i];
+        path[kept++] = from;
+    }
+    path[kept++] = path.back();
+    path.resize(kept);
+}
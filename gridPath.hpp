@@ -0,0 +1,99 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <string>
+
+// Path searches on the farm grid, independent of GameSim so they can be run (and
+// benchmarked) on any walkability map.
+
+class WalkBits;
+
+// Walkable tiles as a search sees them: columns outside [minCol, endCol) count as blocked
+// (the side of the divider a farmer must stay on)
+struct PathGrid {
+    const std::uint8_t* walkable = nullptr; // cols * rows, row-major
+    int cols = 0;
+    int rows = 0;
+    int minCol = 0;
+    int endCol = 0;
+    const WalkBits* bits = nullptr; // the same tiles packed (optional, kept up to date by the owner)
+
+    bool open(int x, int y) const {
+        return x >= minCol && x < endCol && y >= 0 && y < rows && walkable[y * cols + x];
+    }
+};
+
+// The open tiles of a PathGrid, one bit each, inside a border of blocked tiles: a search
+// reaches any neighbour by adding an offset and tests it with a single bit, no bounds or
+// column checks. Cells are numbered (y + 1) * stride + x + 1, in the same order as tiles.
+class WalkBits {
+public:
+    void build(const PathGrid& grid);
+    // The tile's walkability changed (the grid already shows the new value)
+    void update(const PathGrid& grid, int tile);
+
+    bool open(int cell) const { return (words[static_cast<std::size_t>(cell) >> 6] >> (cell & 63)) & 1u; }
+    // The 64 cells from cell on (bit 0 is cell) / up to cell (bit 63 is cell); cells off
+    // either end of the map read as blocked
+    std::uint64_t after(int cell) const;
+    std::uint64_t before(int cell) const;
+    int getStride() const { return stride; }
+    int getCellCount() const { return stride * (rows + 2); }
+    int cellOf(int tile) const { return (tile / cols + 1) * stride + tile % cols + 1; }
+    int tileOf(int cell) const { return (cell / stride - 1) * cols + cell % stride - 1; }
+
+private:
+    int cols = 0;
+    int rows = 0;
+    int stride = 0;
+    std::vector<std::uint64_t> words;
+};
+
+// Which search finds the farmers' paths. The 8-directional ones also step diagonally
+// (never across the corner of a blocked tile).
+enum class PathAlgorithm : std::uint8_t {
+    AStar,      // 4 directions
+    AStar8,
+    JumpPoint,  // Jump Point Search: same path lengths as A*, far fewer expansions
+    JumpPoint8,
+    Hierarchical, // HPA* (see hierarchicalPath.hpp), 4 directions: needs the cluster graph,
+                  // without it (plain findPath) this runs AStar
+    DStarLite     // incremental (see dStarLite.hpp), 4 directions: a planner per walker that
+                  // repairs its path when tiles change; plain findPath runs AStar
+};
+
+const char* pathAlgorithmName(PathAlgorithm a);
+// Algorithm for a pathAlgorithmName ("astar", "jps8"...); false if there's none
+bool parsePathAlgorithm(const std::string& name, PathAlgorithm& out);
+bool isDiagonal(PathAlgorithm a);
+
+// Work done by one search, for benchmarks
+struct PathStats {
+    int expanded = 0; // nodes taken off the open list
+    int scanned = 0;  // tiles looked at while jumping (JPS) or inside clusters (HPA*)
+};
+
+// Cost of one straight / diagonal step; path costs are in these units
+static constexpr int straightCost = 10;
+static constexpr int diagonalCost = 14;
+
+// Tiles from start to goal (both included), every one next to the previous; empty if
+// the goal can't be reached. stats, if given, is added to.
+std::vector<int> findPath(PathAlgorithm algorithm, const PathGrid& grid, int start, int goal,
+                          PathStats* stats = nullptr);
+// Same, into path (replacing what's there); false if the goal can't be reached.
+// The A* and JPS searches work in memory kept per thread and reuse path's storage, so once a
+// thread has searched the grid before they don't allocate.
+bool findPath(PathAlgorithm algorithm, const PathGrid& grid, int start, int goal, std::vector<int>& path,
+              PathStats* stats = nullptr);
+
+// Cost of a path returned by findPath
+int pathCost(const std::vector<int>& path, int cols);
+
+// Whether a walker going straight from the centre of tile a to the centre of tile b only
+// crosses open tiles, with clearance (in tiles, below half a tile) to spare on both sides
+bool lineOfSight(const PathGrid& grid, int a, int b, float clearance = 0.f);
+// Any-angle smoothing: drop the tiles of a findPath path that the walker can go straight
+// past (lineOfSight from the last tile kept to the one after), leaving the corners of a
+// few straight segments. Steps between the tiles kept are no longer single tiles.
+void smoothPath(const PathGrid& grid, std::vector<int>& path, float clearance = 0.f);
@@ -0,0 +1,330 @@
+#include "hierarchicalPath.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+
+constexpr int HierarchicalPaths::defaultClusterSize;
+
+namespace {
+const int dx[4] = {1, -1, 0, 0};
+const int dy[4] = {0, 0, 1, -1};
+// entrances at least this wide get a transition at each end instead of one in the middle
+const int wideEntrance = 6;
+
+// Memory the searches work in, kept per thread: once a thread has searched a map this
+// size before, findPath doesn't allocate
+struct SearchScratch {
+    std::vector<int> cost, from, queue; // searchArea
+    std::vector<int> toGoal, gScore, cameFrom, hops;
+    std::vector<char> closed;
+    std::vector<std::pair<int, int>> open; // (f, node id) heap, smallest f on top
+};
+
+thread_local SearchScratch scratch;
+}
+
+void HierarchicalPaths::build(const PathGrid& g, int clusterSize) {
+    grid = g;
+    size = std::max(4, clusterSize);
+    const int width = std::max(0, grid.endCol - grid.minCol);
+    clustersX = (width + size - 1) / size;
+    clustersY = (grid.rows + size - 1) / size;
+
+    clusters.assign(static_cast<std::size_t>(clustersX * clustersY), Cluster());
+    for (int cy = 0; cy < clustersY; ++cy) {
+        for (int cx = 0; cx < clustersX; ++cx) {
+            Area& a = clusters[static_cast<std::size_t>(cy * clustersX + cx)].area;
+            a.x0 = grid.minCol + cx * size;
+            a.y0 = cy * size;
+            a.w = std::min(size, grid.endCol - a.x0);
+            a.h = std::min(size, grid.rows - a.y0);
+        }
+    }
+    update();
+}
+
+int HierarchicalPaths::clusterOf(int x, int y) const {
+    return (y / size) * clustersX + (x - grid.minCol) / size;
+}
+
+int HierarchicalPaths::nodeId(int c, int tile) const {
+    const Cluster& cl = clusters[static_cast<std::size_t>(c)];
+    auto it = std::lower_bound(cl.nodes.begin(), cl.nodes.end(), tile);
+    if (it == cl.nodes.end() || *it != tile) return -1;
+    return cl.firstId + static_cast<int>(it - cl.nodes.begin());
+}
+
+void HierarchicalPaths::tileChanged(int tile) {
+    if (!isBuilt() || tile < 0 || tile >= grid.cols * grid.rows) return;
+    const int x = tile % grid.cols, y = tile / grid.cols;
+    if (x < grid.minCol || x >= grid.endCol) return;
+    const int c = clusterOf(x, y);
+    const Area& a = clusters[static_cast<std::size_t>(c)].area;
+    clusters[static_cast<std::size_t>(c)].dirty = true;
+
+    // a border tile is half of an entrance: the cluster across it changes too
+    if (x == a.x0 && x > grid.minCol) clusters[static_cast<std::size_t>(c - 1)].dirty = true;
+    if (x == a.x0 + a.w - 1 && x + 1 < grid.endCol) clusters[static_cast<std::size_t>(c + 1)].dirty = true;
+    if (y == a.y0 && y > 0) clusters[static_cast<std::size_t>(c - clustersX)].dirty = true;
+    if (y == a.y0 + a.h - 1 && y + 1 < grid.rows) clusters[static_cast<std::size_t>(c + clustersX)].dirty = true;
+}
+
+// Transition tiles on a's side of its border with the neighbouring cluster b
+void HierarchicalPaths::addTransitions(int a, int b, std::vector<int>& tilesOfA) const {
+    const Area& ca = clusters[static_cast<std::size_t>(a)].area;
+    const Area& cb = clusters[static_cast<std::size_t>(b)].area;
+    // border tiles of a: (x, y) + i * (stepX, stepY); the tile across is (x + ox, y + oy)
+    int x = ca.x0, y = ca.y0, stepX = 0, stepY = 0, ox = 0, oy = 0, length = 0;
+    if (cb.y0 == ca.y0) {
+        stepY = 1;
+        length = ca.h;
+        ox = cb.x0 > ca.x0 ? 1 : -1;
+        if (ox > 0) x = ca.x0 + ca.w - 1;
+    } else {
+        stepX = 1;
+        length = ca.w;
+        oy = cb.y0 > ca.y0 ? 1 : -1;
+        if (oy > 0) y = ca.y0 + ca.h - 1;
+    }
+
+    auto add = [&](int i) { tilesOfA.push_back((y + i * stepY) * grid.cols + x + i * stepX); };
+    int runStart = -1;
+    for (int i = 0; i <= length; ++i) {
+        const int tx = x + i * stepX, ty = y + i * stepY;
+        const bool pair = i < length && grid.open(tx, ty) && grid.open(tx + ox, ty + oy);
+        if (pair && runStart < 0) runStart = i;
+        if (pair || runStart < 0) continue;
+        const int runEnd = i - 1;
+        if (runEnd - runStart + 1 < wideEntrance) {
+            add((runStart + runEnd) / 2);
+        } else {
+            add(runStart);
+            add(runEnd);
+        }
+        runStart = -1;
+    }
+}
+
+void HierarchicalPaths::findNodes(int c) {
+    Cluster& cl = clusters[static_cast<std::size_t>(c)];
+    const int cx = c % clustersX, cy = c / clustersX;
+    cl.nodes.clear();
+    if (cx > 0) addTransitions(c, c - 1, cl.nodes);
+    if (cx + 1 < clustersX) addTransitions(c, c + 1, cl.nodes);
+    if (cy > 0) addTransitions(c, c - clustersX, cl.nodes);
+    if (cy + 1 < clustersY) addTransitions(c, c + clustersX, cl.nodes);
+    std::sort(cl.nodes.begin(), cl.nodes.end());
+    cl.nodes.erase(std::unique(cl.nodes.begin(), cl.nodes.end()), cl.nodes.end());
+}
+
+// Path costs between every two nodes of the cluster
+void HierarchicalPaths::linkNodes(int c) {
+    Cluster& cl = clusters[static_cast<std::size_t>(c)];
+    const int k = static_cast<int>(cl.nodes.size());
+    cl.cost.assign(static_cast<std::size_t>(k * k), -1);
+    std::vector<int> cost, from;
+    for (int i = 0; i < k; ++i) {
+        searchArea(cl.area, cl.nodes[i], -1, cost, from);
+        for (int j = 0; j < k; ++j) {
+            cl.cost[static_cast<std::size_t>(i * k + j)] = cost[cl.area.local(cl.nodes[j], grid.cols)];
+        }
+    }
+}
+
+void HierarchicalPaths::update() {
+    bool changed = false;
+    for (int c = 0; c < static_cast<int>(clusters.size()); ++c) {
+        if (clusters[static_cast<std::size_t>(c)].dirty) findNodes(c);
+    }
+    for (int c = 0; c < static_cast<int>(clusters.size()); ++c) {
+        if (!clusters[static_cast<std::size_t>(c)].dirty) continue;
+        linkNodes(c);
+        clusters[static_cast<std::size_t>(c)].dirty = false;
+        changed = true;
+    }
+    if (!changed) return;
+
+    // number the nodes again, cluster by cluster
+    nodeTile.clear();
+    nodeCluster.clear();
+    for (int c = 0; c < static_cast<int>(clusters.size()); ++c) {
+        Cluster& cl = clusters[static_cast<std::size_t>(c)];
+        cl.firstId = static_cast<int>(nodeTile.size());
+        for (int t : cl.nodes) {
+            nodeTile.push_back(t);
+            nodeCluster.push_back(c);
+        }
+    }
+}
+
+int HierarchicalPaths::searchArea(const Area& a, int start, int stopAt, std::vector<int>& cost, std::vector<int>& from) const {
+    cost.assign(static_cast<std::size_t>(a.w * a.h), -1);
+    from.assign(static_cast<std::size_t>(a.w * a.h), -1);
+
+    std::vector<int>& queue = scratch.queue; // tiles, in the order they were reached
+    queue.clear();
+    queue.push_back(start);
+    cost[a.local(start, grid.cols)] = 0;
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const int t = queue[head];
+        if (t == stopAt) return static_cast<int>(head + 1);
+        const int x = t % grid.cols, y = t / grid.cols;
+        const int tc = cost[a.local(t, grid.cols)];
+        for (int k = 0; k < 4; ++k) {
+            const int nx = x + dx[k], ny = y + dy[k];
+            if (nx < a.x0 || nx >= a.x0 + a.w || ny < a.y0 || ny >= a.y0 + a.h || !grid.open(nx, ny)) continue;
+            const int n = ny * grid.cols + nx;
+            if (cost[a.local(n, grid.cols)] >= 0) continue;
+            cost[a.local(n, grid.cols)] = tc + straightCost;
+            from[a.local(n, grid.cols)] = t;
+            queue.push_back(n);
+        }
+    }
+    return static_cast<int>(queue.size());
+}
+
+bool HierarchicalPaths::appendHop(const Area& area, int fromTile, int to, std::vector<int>& path, PathStats* stats) const {
+    if (fromTile == to) return true;
+    if (std::abs(fromTile % grid.cols - to % grid.cols) + std::abs(fromTile / grid.cols - to / grid.cols) == 1) {
+        path.push_back(to);
+        return true;
+    }
+    std::vector<int>& cost = scratch.cost;
+    std::vector<int>& from = scratch.from;
+    const int visited = searchArea(area, fromTile, to, cost, from);
+    if (stats) stats->scanned += visited;
+    if (cost[area.local(to, grid.cols)] < 0) return false;
+
+    const std::size_t mark = path.size();
+    for (int t = to; t != fromTile; t = from[area.local(t, grid.cols)]) path.push_back(t);
+    std::reverse(path.begin() + static_cast<std::ptrdiff_t>(mark), path.end());
+    return true;
+}
+
+std::vector<int> HierarchicalPaths::findPath(int start, int goal, PathStats* stats) const {
+    std::vector<int> path;
+    findPath(start, goal, path, stats);
+    return path;
+}
+
+bool HierarchicalPaths::findPath(int start, int goal, std::vector<int>& path, PathStats* stats) const {
+    path.clear();
+    const int tiles = grid.cols * grid.rows;
+    if (!isBuilt() || start < 0 || goal < 0 || start >= tiles || goal >= tiles) return false;
+    path.push_back(start);
+    if (start == goal) return true;
+    const int sx = start % grid.cols, sy = start / grid.cols;
+    const int gx = goal % grid.cols, gy = goal / grid.cols;
+    if (sx < grid.minCol || sx >= grid.endCol || !grid.open(gx, gy)) { path.clear(); return false; }
+
+    const int cs = clusterOf(sx, sy);
+    const int cg = clusterOf(gx, gy);
+    SearchScratch& sc = scratch;
+    std::vector<int>& cost = sc.cost;
+    std::vector<int>& from = sc.from;
+
+    // ends in the same or neighbouring clusters: a path inside those will do (the
+    // detour through the transitions would be long compared to the trip)
+    const Area& sa = clusters[static_cast<std::size_t>(cs)].area;
+    const Area& ga = clusters[static_cast<std::size_t>(cg)].area;
+    if (std::abs(cs % clustersX - cg % clustersX) <= 1 && std::abs(cs / clustersX - cg / clustersX) <= 1) {
+        Area both;
+        both.x0 = std::min(sa.x0, ga.x0);
+        both.y0 = std::min(sa.y0, ga.y0);
+        both.w = std::max(sa.x0 + sa.w, ga.x0 + ga.w) - both.x0;
+        both.h = std::max(sa.y0 + sa.h, ga.y0 + ga.h) - both.y0;
+        if (appendHop(both, start, goal, path, stats)) return true;
+        path.resize(1);
+    }
+
+    // how the ends reach the nodes of their clusters
+    const Cluster& startCl = clusters[static_cast<std::size_t>(cs)];
+    const Cluster& goalCl = clusters[static_cast<std::size_t>(cg)];
+    int visited = searchArea(ga, goal, -1, cost, from);
+    std::vector<int>& toGoal = sc.toGoal;
+    toGoal.resize(goalCl.nodes.size());
+    for (std::size_t i = 0; i < toGoal.size(); ++i) toGoal[i] = cost[ga.local(goalCl.nodes[i], grid.cols)];
+    visited += searchArea(sa, start, -1, cost, from);
+    if (stats) stats->scanned += visited;
+
+    // A* over the nodes; id M is the goal
+    const int M = getNodeCount();
+    const int INF = std::numeric_limits<int>::max();
+    std::vector<int>& gScore = sc.gScore;
+    std::vector<int>& cameFrom = sc.cameFrom;
+    std::vector<char>& closed = sc.closed;
+    std::vector<std::pair<int, int>>& openSet = sc.open;
+    gScore.assign(static_cast<std::size_t>(M + 1), INF);
+    cameFrom.assign(static_cast<std::size_t>(M + 1), -1);
+    closed.assign(static_cast<std::size_t>(M + 1), 0);
+    openSet.clear();
+    const std::greater<std::pair<int, int>> later;
+
+    auto relax = [&](int id, int via, int g) {
+        if (g >= gScore[static_cast<std::size_t>(id)]) return;
+        gScore[static_cast<std::size_t>(id)] = g;
+        cameFrom[static_cast<std::size_t>(id)] = via;
+        int h = 0;
+        if (id < M) {
+            const int t = nodeTile[static_cast<std::size_t>(id)];
+            h = straightCost * (std::abs(t % grid.cols - gx) + std::abs(t / grid.cols - gy));
+        }
+        openSet.emplace_back(g + h, id);
+        std::push_heap(openSet.begin(), openSet.end(), later);
+    };
+    for (std::size_t i = 0; i < startCl.nodes.size(); ++i) {
+        const int c = cost[sa.local(startCl.nodes[i], grid.cols)];
+        if (c >= 0) relax(startCl.firstId + static_cast<int>(i), -1, c);
+    }
+
+    while (!openSet.empty()) {
+        std::pop_heap(openSet.begin(), openSet.end(), later);
+        const int n = openSet.back().second;
+        openSet.pop_back();
+        if (closed[static_cast<std::size_t>(n)]) continue;
+        if (n == M) break;
+        closed[static_cast<std::size_t>(n)] = 1;
+        if (stats) stats->expanded++;
+
+        const int g = gScore[static_cast<std::size_t>(n)];
+        const int c = nodeCluster[static_cast<std::size_t>(n)];
+        const Cluster& cl = clusters[static_cast<std::size_t>(c)];
+        const int k = static_cast<int>(cl.nodes.size());
+        const int i = n - cl.firstId;
+
+        for (int j = 0; j < k; ++j) {
+            const int edge = cl.cost[static_cast<std::size_t>(i * k + j)];
+            if (j != i && edge >= 0) relax(cl.firstId + j, n, g + edge);
+        }
+        const int t = nodeTile[static_cast<std::size_t>(n)];
+        const int x = t % grid.cols, y = t / grid.cols;
+        for (int d = 0; d < 4; ++d) {
+            const int nx = x + dx[d], ny = y + dy[d];
+            if (!grid.open(nx, ny)) continue;
+            const int nc = clusterOf(nx, ny);
+            if (nc == c) continue;
+            const int m = nodeId(nc, ny * grid.cols + nx);
+            if (m >= 0) relax(m, n, g + straightCost);
+        }
+        if (c == cg && toGoal[static_cast<std::size_t>(i)] >= 0) relax(M, n, g + toGoal[static_cast<std::size_t>(i)]);
+    }
+    if (gScore[static_cast<std::size_t>(M)] == INF) { path.clear(); return false; }
+
+    // the nodes passed, then the tiles between them
+    std::vector<int>& hops = sc.hops;
+    hops.clear();
+    for (int n = cameFrom[static_cast<std::size_t>(M)]; n != -1; n = cameFrom[static_cast<std::size_t>(n)]) {
+        hops.push_back(nodeTile[static_cast<std::size_t>(n)]);
+    }
+    std::reverse(hops.begin(), hops.end());
+    hops.push_back(goal);
+
+    int cur = start;
+    for (int t : hops) {
+        const Area& hopArea = clusters[static_cast<std::size_t>(clusterOf(t % grid.cols, t / grid.cols))].area;
+        if (!appendHop(hopArea, cur, t, path, stats)) { path.clear(); return false; }
+        cur = t;
+    }
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "gridPath.hpp"
+
+// Hierarchical path search (HPA*) for large grids, 4 directions.
+// The grid is cut into clusters of clusterSize x clusterSize tiles. Where two clusters
+// touch, every run of open tile pairs across the border is an entrance with one or two
+// transition tiles on each side; the transitions of a cluster are the nodes of a small
+// abstract graph, linked by their path costs inside the cluster (precomputed) and by
+// the single steps across borders. A query searches the abstract graph and then fills
+// in each hop with a search inside one cluster, so it never touches the whole grid.
+// Paths are close to optimal, not always optimal (they pass through transitions).
+class HierarchicalPaths {
+public:
+    static constexpr int defaultClusterSize = 16;
+
+    // Cut the grid (its open tiles, see PathGrid) into clusters and link them. The grid's
+    // walkable array must stay where it is for as long as this is used.
+    void build(const PathGrid& grid, int clusterSize = defaultClusterSize);
+    bool isBuilt() const { return !clusters.empty(); }
+
+    // A tile's walkability changed: its cluster (and the neighbour, for a border tile)
+    // is relinked at the next update
+    void tileChanged(int tile);
+    // Relink the clusters changed since the last update; call before searching again
+    void update();
+
+    // Tiles from start to goal (both included) like ::findPath; empty if the goal can't
+    // be reached. Several threads may search at once (between updates).
+    std::vector<int> findPath(int start, int goal, PathStats* stats = nullptr) const;
+    // Same, into path (replacing what's there); false if the goal can't be reached. Works
+    // in memory kept per thread, so repeated searches don't allocate.
+    bool findPath(int start, int goal, std::vector<int>& path, PathStats* stats = nullptr) const;
+
+    int getClusterCount() const { return static_cast<int>(clusters.size()); }
+    int getNodeCount() const { return static_cast<int>(nodeTile.size()); }
+
+private:
+    // Rectangle of tiles
+    struct Area {
+        int x0 = 0, y0 = 0, w = 0, h = 0;
+        std::size_t local(int tile, int cols) const {
+            return static_cast<std::size_t>((tile / cols - y0) * w + tile % cols - x0);
+        }
+    };
+
+    struct Cluster {
+        Area area;                        // tiles covered
+        std::vector<int> nodes;           // transition tiles, ascending
+        std::vector<int> cost;            // nodes x nodes path costs inside the cluster, -1 if none
+        int firstId = 0;                  // abstract node id of nodes[0]
+        bool dirty = true;
+    };
+
+    int clusterOf(int x, int y) const;
+    int nodeId(int cluster, int tile) const; // -1 if tile isn't one of the cluster's nodes
+    void addTransitions(int a, int b, std::vector<int>& tilesOfA) const;
+    void findNodes(int c);
+    void linkNodes(int c);
+
+    // Breadth-first search inside area from start: cost to every tile of it (-1 if
+    // unreachable, indexed by Area::local), stopping early at stopAt if that's >= 0;
+    // from[] gets each tile's predecessor. Returns the number of tiles visited.
+    int searchArea(const Area& area, int start, int stopAt, std::vector<int>& cost, std::vector<int>& from) const;
+    // Append the tiles after from up to to, searched inside area (unless they're neighbours)
+    bool appendHop(const Area& area, int from, int to, std::vector<int>& path, PathStats* stats) const;
+
+    PathGrid grid;
+    int size = defaultClusterSize;
+    int clustersX = 0;
+    int clustersY = 0;
+    std::vector<Cluster> clusters;
+    std::vector<int> nodeTile;    // abstract node id -> tile
+    std::vector<int> nodeCluster; // abstract node id -> cluster
+};
@@ -0,0 +1,154 @@
+#include "jobSystem.hpp"
+#include <algorithm>
+
+// Graph
+
+JobGraph::JobId JobGraph::push(int body, int begin, int end, std::initializer_list<JobId> after) {
+    JobId id = static_cast<JobId>(jobs.size());
+    jobs.emplace_back();
+    Job& job = jobs.back();
+    job.body = body;
+    job.begin = begin;
+    job.end = end;
+    for (JobId before : after) {
+        if (before < 0 || before >= id) continue; // only earlier jobs, so the graph has no cycles
+        jobs[before].next.push_back(id);
+        job.dependencies++;
+    }
+    return id;
+}
+
+JobGraph::JobId JobGraph::add(std::function<void()> fn, std::initializer_list<JobId> after) {
+    bodies.emplace_back([fn](int, int) { fn(); });
+    return push(static_cast<int>(bodies.size()) - 1, 0, 0, after);
+}
+
+JobGraph::JobId JobGraph::parallelFor(int count, int grain, std::function<void(int, int)> body,
+                                      std::initializer_list<JobId> after) {
+    grain = std::max(1, grain);
+    bodies.push_back(std::move(body));
+    const int bodyIndex = static_cast<int>(bodies.size()) - 1;
+
+    std::vector<JobId> ranges;
+    for (int begin = 0; begin < count; begin += grain) {
+        ranges.push_back(push(bodyIndex, begin, std::min(count, begin + grain), after));
+    }
+    JobId join = push(-1, 0, 0, after);
+    for (JobId r : ranges) {
+        jobs[r].next.push_back(join);
+        jobs[join].dependencies++;
+    }
+    return join;
+}
+
+void JobGraph::clear() {
+    bodies.clear();
+    jobs.clear();
+}
+
+// Scheduler
+
+JobSystem& JobSystem::instance() {
+    static JobSystem pool;
+    return pool;
+}
+
+JobSystem::JobSystem(int workers) {
+    if (workers < 0) workers = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+
+    for (int i = 0; i <= workers; ++i) queues.emplace_back(new Queue());
+    for (int i = 0; i < workers; ++i) threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+void JobSystem::run(JobGraph& g) {
+    const int n = g.size();
+    if (n == 0) return;
+
+    if (n > waitingSize) {
+        waiting.reset(new std::atomic<int>[n]);
+        waitingSize = n;
+    }
+    for (int i = 0; i < n; ++i) waiting[i].store(g.jobs[i].dependencies, std::memory_order_relaxed);
+    graph = &g;
+
+    // count first: a worker may pick up a job as soon as it is queued
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        unfinished.store(n);
+    }
+    const int self = static_cast<int>(queues.size()) - 1;
+    for (int i = 0; i < n; ++i) {
+        if (g.jobs[i].dependencies == 0) push(self, i);
+    }
+    if (!threads.empty()) wake.notify_all();
+
+    while (unfinished.load(std::memory_order_acquire) > 0) {
+        if (!runOne(self)) std::this_thread::yield();
+    }
+    graph = nullptr;
+}
+
+void JobSystem::workerLoop(int self) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [this] { return quit || unfinished.load() > 0; });
+            if (quit) return;
+        }
+        while (unfinished.load(std::memory_order_acquire) > 0) {
+            if (!runOne(self)) std::this_thread::yield();
+        }
+    }
+}
+
+// Run one ready job (own queue first, then stolen); false if there was none
+bool JobSystem::runOne(int self) {
+    int id = -1;
+    if (!pop(self, id) && !steal(self, id)) return false;
+
+    const JobGraph::Job& job = graph->jobs[id];
+    if (job.body >= 0) graph->bodies[job.body](job.begin, job.end);
+
+    // dependants that were only waiting for this job are ready now
+    for (int next : job.next) {
+        if (waiting[next].fetch_sub(1, std::memory_order_acq_rel) == 1) push(self, next);
+    }
+    unfinished.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void JobSystem::push(int queue, int job) {
+    std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+    queues[queue]->jobs.push_back(job);
+}
+
+bool JobSystem::pop(int queue, int& job) {
+    Queue& q = *queues[queue];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.jobs.empty()) return false;
+    job = q.jobs.back(); // newest first: its data is likely still in this core's cache
+    q.jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(int thief, int& job) {
+    const int count = static_cast<int>(queues.size());
+    for (int k = 1; k < count; ++k) {
+        Queue& q = *queues[(thief + k) % count];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.jobs.empty()) continue;
+        job = q.jobs.front(); // oldest: usually the biggest piece of remaining work
+        q.jobs.pop_front();
+        return true;
+    }
+    return false;
+}
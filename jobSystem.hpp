@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A set of jobs and the order they must run in, handed to JobSystem::run.
+// Jobs that do not depend on each other may run at the same time on different threads,
+// so they must not write the same data. Build it, run it, clear it, build the next one.
+class JobGraph {
+public:
+    using JobId = int;
+
+    // Job that starts once every job in after is done
+    JobId add(std::function<void()> fn, std::initializer_list<JobId> after = {});
+
+    // Split [0, count) into ranges of at most grain items and call body(begin, end) for
+    // each, as separate jobs. Returns a job that is done when all ranges are.
+    JobId parallelFor(int count, int grain, std::function<void(int, int)> body,
+                      std::initializer_list<JobId> after = {});
+
+    void clear();
+    int size() const { return static_cast<int>(jobs.size()); }
+
+private:
+    friend class JobSystem;
+
+    struct Job {
+        int body = -1;          // index into bodies, -1 for a join point
+        int begin = 0;
+        int end = 0;
+        int dependencies = 0;   // jobs this one waits for
+        std::vector<JobId> next; // jobs waiting for this one
+    };
+
+    JobId push(int body, int begin, int end, std::initializer_list<JobId> after);
+
+    std::vector<std::function<void(int, int)>> bodies;
+    std::vector<Job> jobs;
+};
+
+// Engine-wide worker pool. Each thread has its own queue of ready jobs: it takes the
+// newest job from its own queue and, when that is empty, steals the oldest from another.
+// The thread calling run works along until the graph is done.
+class JobSystem {
+public:
+    // Shared pool with one worker per extra core
+    static JobSystem& instance();
+
+    // workers < 0: one per core besides the calling thread; 0 runs every job on the caller
+    explicit JobSystem(int workers = -1);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int getWorkerCount() const { return static_cast<int>(threads.size()); }
+
+    // Run every job of the graph, each after its dependencies, and return when all are
+    // done. One graph at a time: run is not re-entrant and not for several callers.
+    void run(JobGraph& graph);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<int> jobs;
+    };
+
+    void workerLoop(int self);
+    bool runOne(int self);
+    void push(int queue, int job);
+    bool pop(int queue, int& job);
+    bool steal(int thief, int& job);
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker, the caller's last
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool quit = false;
+
+    // the graph being run
+    JobGraph* graph = nullptr;
+    std::unique_ptr<std::atomic<int>[]> waiting; // per job, dependencies not yet done
+    int waitingSize = 0;
+    std::atomic<int> unfinished{0};
+};
@@ -10,7 +10,9 @@
 #include "scores.hpp"
 #include "player.hpp"
 #include "spriteLib.hpp"
+#include "replay.hpp"
 #include <iostream>
+#include <chrono>
 
 enum class Screen { Menu, Game, Level, Settings, Map, Scores, Account, GameSettings, LevelSettings, Player };
 
@@ -19,7 +21,42 @@ int currentLevel = 1;   // for now: always level 1, later change from LevelSetti
 
 
 
-int main() {
+// Re-simulate a replay without a window, as fast as the CPU allows, and print the result
+static int runReplayFast(ReplayPlayer& replay) {
+    GameSim sim(replay.getLevelID(), replay.getSeed());
+    sim.setJobSystem(&JobSystem::instance());
+    auto start = std::chrono::steady_clock::now();
+    while (replay.step(sim)) {}
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const char* winner = "none";
+    if (sim.getWinner() == Winner::Player) winner = "player";
+    else if (sim.getWinner() == Winner::AI) winner = "AI";
+    else if (sim.getWinner() == Winner::Tie) winner = "tie";
+
+    std::cout << "Replay: level " << sim.getLevelID() << ", seed " << sim.getSeed()
+              << ", " << sim.getTick() << " ticks (" << sim.getTick() * GameSim::fixedStep << " s) in " << ms << " ms\n"
+              << "Player " << sim.getPlayerScore() << " - AI " << sim.getAIScore() << ", winner: " << winner << "\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+
+    // "--replay <file>" watches a recorded match, "--fast" re-simulates it without a window,
+    // "--debug" turns on the debugging keys (Backspace rewinds the match)
+    std::string replayPath;
+    bool fastReplay = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--replay" && i + 1 < argc) replayPath = argv[++i];
+        else if (arg == "--fast") fastReplay = true;
+        else if (arg == "--debug") Game::debugKeys = true;
+    }
+    ReplayPlayer replay;
+    if (!replayPath.empty()) {
+        if (!replay.open(replayPath)) return 1;
+        if (fastReplay) return runReplayFast(replay);
+    }
 
     sf::RenderWindow window(sf::VideoMode(960, 540), "Overgrown");
     window.setVerticalSyncEnabled(true);
@@ -65,6 +102,11 @@ int main() {
     // AI texture index already set to dedicated AI sprite above
 
     Game* game = nullptr;  // pointer so we can reset the game when starting a new one
+
+    if (!replayPath.empty()) {
+        game = new Game(window, replay);
+        screen = Screen::Game;
+    }
     
     sf::Clock clk;
 
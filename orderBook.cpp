@@ -0,0 +1,164 @@
+#include "orderBook.hpp"
+
+constexpr int Request::maxItems;
+constexpr int OrderBook::cropCount;
+
+void Request::add(CropType crop, int qty) {
+    if (itemCount >= maxItems) return;
+    Item& item = items[itemCount++];
+    item.crop = crop;
+    item.remaining = static_cast<std::uint16_t>(qty);
+    item.initial = static_cast<std::uint16_t>(qty);
+}
+
+int Request::find(CropType crop) const {
+    for (int i = 0; i < itemCount; ++i) {
+        if (items[i].crop == crop) return i;
+    }
+    return -1;
+}
+
+void OrderBook::reset(int openLimit, int lookAhead, int totalRequests) {
+    total = totalRequests;
+    generated = 0;
+    retired = Totals();
+
+    upcoming.assign(static_cast<std::size_t>(std::max(1, lookAhead)), Request());
+    upcomingHead = 0;
+    upcomingCount = 0;
+
+    const int limit = std::max(1, openLimit);
+    slots.assign(static_cast<std::size_t>(limit), Request());
+    freeSlots.clear();
+    for (int s = limit - 1; s >= 0; --s) freeSlots.push_back(s);
+    openCount = 0;
+    ages.clear();
+    for (auto& q : waiting) q.clear();
+}
+
+bool OrderBook::wantsMore() const {
+    return upcomingCount < static_cast<int>(upcoming.size()) && (total < 0 || generated < total);
+}
+
+void OrderBook::add(Request r) {
+    if (upcomingCount == static_cast<int>(upcoming.size())) return;
+    r.id = generated++;
+    upcoming[static_cast<std::size_t>((upcomingHead + upcomingCount) % static_cast<int>(upcoming.size()))] = r;
+    upcomingCount++;
+    openWaiting();
+}
+
+const Request& OrderBook::getUpcoming(int i) const {
+    return upcoming[static_cast<std::size_t>((upcomingHead + i) % static_cast<int>(upcoming.size()))];
+}
+
+// Move waiting requests into free slots, oldest first
+void OrderBook::openWaiting() {
+    while (!freeSlots.empty() && upcomingCount > 0) {
+        const int s = freeSlots.back();
+        freeSlots.pop_back();
+        Request& r = slots[static_cast<std::size_t>(s)];
+        r = upcoming[static_cast<std::size_t>(upcomingHead)];
+        upcomingHead = (upcomingHead + 1) % static_cast<int>(upcoming.size());
+        upcomingCount--;
+
+        openCount++;
+        ages.push({r.id, s});
+        for (const Request::Item& item : r) {
+            if (item.remaining > 0) waiting[static_cast<int>(item.crop)].push(s);
+        }
+    }
+}
+
+// Fold a finished request into the totals and free its slot
+void OrderBook::retire(int s) {
+    Request& r = slots[static_cast<std::size_t>(s)];
+    retired.requests++;
+    for (const Request::Item& item : r) {
+        retired.units += item.initial;
+        retired.playerUnits += item.playerContrib;
+        retired.aiUnits += item.aiContrib;
+    }
+    r.id = -1;
+    freeSlots.push_back(s);
+    openCount--;
+
+    while (!ages.empty() && !isCurrent(ages.front())) ages.pop();
+    // requests finished out of order leave stale entries behind the oldest one
+    if (ages.size() > 2 * static_cast<int>(slots.size())) {
+        ages.removeIf([this](const AgeEntry& e) { return !isCurrent(e); });
+    }
+    openWaiting();
+}
+
+OrderBook::Sale OrderBook::deliver(CropType crop, Side side) {
+    Sale sale;
+    const int c = static_cast<int>(crop);
+    if (c <= 0 || c >= cropCount || waiting[c].empty()) return sale;
+
+    const int s = waiting[c].front();
+    Request& r = slots[static_cast<std::size_t>(s)];
+    sale.request = r.id;
+    sale.slot = r.find(crop);
+    Request::Item& item = r.items[sale.slot];
+    item.remaining -= 1;
+    if (side == Side::Player) item.playerContrib += 1;
+    else item.aiContrib += 1;
+
+    if (item.remaining > 0) return sale;
+    // this request needs no more of the crop: the next one in line gets the following units
+    waiting[c].pop();
+
+    for (const Request::Item& it : r) {
+        if (it.remaining > 0) return sale;
+    }
+    sale.completed = true;
+    for (const Request::Item& it : r) {
+        sale.units += it.initial;
+        sale.playerUnits += it.playerContrib;
+        sale.aiUnits += it.aiContrib;
+    }
+    retire(s);
+    return sale;
+}
+
+const Request* OrderBook::getOldestOpen() const {
+    if (ages.empty()) return nullptr;
+    return &slots[static_cast<std::size_t>(ages.front().slot)];
+}
+
+int OrderBook::getFirstOpen() const {
+    const Request* r = getOldestOpen();
+    return r ? r->id : generated;
+}
+
+CropType OrderBook::mostWanted() const {
+    const Request* r = getOldestOpen();
+    if (!r) return CropType::None;
+    int bestQty = 0;
+    CropType best = CropType::None;
+    for (const Request::Item& item : *r) {
+        if (item.remaining > bestQty) { bestQty = item.remaining; best = item.crop; }
+    }
+    return best;
+}
+
+void OrderBook::restore(const Totals& retiredTotals, int generatedCount,
+                        const std::vector<Request>& open, const std::vector<Request>& waitingRequests) {
+    reset(getOpenLimit(), static_cast<int>(upcoming.size()), total);
+    retired = retiredTotals;
+    generated = generatedCount;
+
+    // open ones first, in age order, then the waiting ones behind them
+    for (const Request& r : open) {
+        if (freeSlots.empty()) break;
+        upcoming[static_cast<std::size_t>(upcomingHead)] = r;
+        upcomingCount = 1;
+        openWaiting();
+    }
+    for (const Request& r : waitingRequests) {
+        if (upcomingCount == static_cast<int>(upcoming.size())) break;
+        upcoming[static_cast<std::size_t>((upcomingHead + upcomingCount) % static_cast<int>(upcoming.size()))] = r;
+        upcomingCount++;
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include "farmGrid.hpp"
+#include "aiAgents.hpp"
+
+// One market request: up to maxItems different crops with quantities, stored inline
+// (no heap memory per request)
+struct Request {
+    static constexpr int maxItems = 3;
+
+    struct Item {
+        CropType crop = CropType::None;
+        std::uint16_t remaining = 0;     // quantity still needed
+        std::uint16_t initial = 0;       // quantity requested
+        std::uint16_t playerContrib = 0; // units the player side has delivered
+        std::uint16_t aiContrib = 0;     // units the AI side has delivered
+    };
+
+    int id = -1; // number of the request in the match (0 = first), set by the order book
+    std::array<Item, maxItems> items;
+    std::uint8_t itemCount = 0;
+
+    // Append a crop (ignored when full)
+    void add(CropType crop, int qty);
+    // Slot of that crop, -1 if the request doesn't list it
+    int find(CropType crop) const;
+    const Item* begin() const { return items.data(); }
+    const Item* end() const { return items.data() + itemCount; }
+};
+
+// First-in first-out list that reuses its storage (pops only move a head index)
+template <class T>
+class FifoQueue {
+public:
+    bool empty() const { return head == items.size(); }
+    int size() const { return static_cast<int>(items.size() - head); }
+    const T& front() const { return items[head]; }
+    const T& operator[](int i) const { return items[head + static_cast<std::size_t>(i)]; }
+    void push(const T& v) { items.push_back(v); }
+    void pop() {
+        if (++head == items.size()) clear();
+        else if (head > 64 && head * 2 > items.size()) {
+            items.erase(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(head));
+            head = 0;
+        }
+    }
+    void clear() { items.clear(); head = 0; }
+    template <class P> void removeIf(P p) {
+        items.erase(std::remove_if(items.begin() + static_cast<std::ptrdiff_t>(head), items.end(), p), items.end());
+        if (empty()) clear();
+    }
+
+private:
+    std::vector<T> items;
+    std::size_t head = 0;
+};
+
+// The requests of a match, streamed: a look-ahead queue of generated requests, up to
+// openLimit open ones in fixed slots, and a running total of the completed ones (which
+// are not kept). Memory stays the same however long the match runs.
+// Every crop keeps a queue of the open requests still needing it (in age order), so a
+// delivery finds its request in O(1).
+class OrderBook {
+public:
+    // Result of one delivery
+    struct Sale {
+        int request = -1;       // id of the request it went to, -1 if no open request needs the crop
+        int slot = -1;          // item slot inside that request
+        bool completed = false; // this delivery finished the request (it's retired already)
+        // when completed: units the request asked for, and delivered by each side
+        int units = 0;
+        int playerUnits = 0;
+        int aiUnits = 0;
+    };
+
+    // What the completed (retired) requests added up to
+    struct Totals {
+        int requests = 0;
+        int units = 0;       // units asked for
+        int playerUnits = 0; // units delivered by each side
+        int aiUnits = 0;
+    };
+
+    // Start over with up to openLimit requests open at once and up to lookAhead waiting
+    // behind them; total is the number of requests in the match, endless if < 0
+    void reset(int openLimit, int lookAhead, int total);
+
+    // The owner generates requests while this says so (room left and total not reached)
+    bool wantsMore() const;
+    // Append the next request (it gets the next id) and open it if there's room
+    void add(Request r);
+
+    // Hand in one unit of crop for a side: goes to the oldest open request needing it
+    Sale deliver(CropType crop, Side side);
+
+    // Oldest open request, nullptr if none
+    const Request* getOldestOpen() const;
+    // Crop with the most units missing in the oldest open request (None if nothing is open)
+    CropType mostWanted() const;
+    // Id of the oldest open request (getGenerated() if none is open)
+    int getFirstOpen() const;
+
+    int getOpenCount() const { return openCount; }
+    int getOpenLimit() const { return static_cast<int>(slots.size()); }
+    int getLookAhead() const { return static_cast<int>(upcoming.size()); }
+    int getTotal() const { return total; }
+    bool isEndless() const { return total < 0; }
+    int getGenerated() const { return generated; }
+    const Totals& getRetired() const { return retired; }
+    bool allCompleted() const { return total >= 0 && retired.requests >= total; }
+
+    // Open requests, oldest first
+    template <class F> void forEachOpen(F f) const {
+        for (int i = 0; i < ages.size(); ++i) {
+            if (isCurrent(ages[i])) f(slots[static_cast<std::size_t>(ages[i].slot)]);
+        }
+    }
+    // Generated requests not open yet, oldest first
+    int getUpcomingCount() const { return upcomingCount; }
+    const Request& getUpcoming(int i) const;
+
+    // Snapshot restore: put back the state described by the getters above
+    void restore(const Totals& retiredTotals, int generatedCount,
+                 const std::vector<Request>& open, const std::vector<Request>& upcoming);
+
+private:
+    static constexpr int cropCount = 6;
+
+    struct AgeEntry { int id; int slot; };
+    bool isCurrent(const AgeEntry& e) const { return slots[static_cast<std::size_t>(e.slot)].id == e.id; }
+
+    void openWaiting();
+    void retire(int slot);
+
+    int total = -1;
+    int generated = 0;
+    Totals retired;
+
+    // Waiting requests: ring of lookAhead entries
+    std::vector<Request> upcoming;
+    int upcomingHead = 0;
+    int upcomingCount = 0;
+
+    // Open requests; a free slot has id -1
+    std::vector<Request> slots;
+    std::vector<int> freeSlots;
+    int openCount = 0;
+    FifoQueue<AgeEntry> ages; // open order; entries of retired requests are skipped
+
+    // Per crop: slots of the open requests needing it, oldest first
+    std::array<FifoQueue<int>, cropCount> waiting;
+};
@@ -0,0 +1,314 @@
+// Path search benchmark: runs the same random start/goal queries through every
+// PathAlgorithm on the shipped levels and on large generated maps, and prints nodes
+// expanded, time per search and whether the path costs match A*. HPA* also reports how
+// much longer its paths are than A*'s, its build time and the update after one tile changes;
+// D* Lite how long it takes to repair a path after a tile on it is blocked, against A*
+// searching again. Then A*, JPS and HPA* are run again into a reused path, and A*
+// through a path cache that misses and evicts, where a search must not allocate once the
+// queries have been searched before (heap allocations are counted; the exit status is 1
+// if any is made), and any-angle smoothing of the A* paths reports how many waypoints it
+// leaves. Before all that, the path cache is checked to keep the paths of different
+// algorithms apart (exit status 1 if it doesn't).
+//
+//   Games-Engineering-PathBench [--queries Q] [--seed S] [--size N]... [--cluster C]
+//
+// --size adds a generated N x N map (default 256 and 1024); --cluster sets the HPA*
+// cluster size.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "gameSim.hpp"
+#include "gridPath.hpp"
+#include "hierarchicalPath.hpp"
+#include "dStarLite.hpp"
+#include "pathCache.hpp"
+
+// Every heap allocation goes through here
+static std::atomic<std::uint64_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+struct BenchMap {
+    std::string name;
+    std::vector<std::uint8_t> walkable;
+    PathGrid grid;
+};
+
+// Open farmland: fields of blocked tiles in rows with paths between them, plus scattered
+// single obstacles (fences, trees)
+static BenchMap makeFarmMap(int size, std::mt19937& rng) {
+    BenchMap m;
+    m.name = "farm " + std::to_string(size) + "x" + std::to_string(size);
+    m.walkable.assign(static_cast<std::size_t>(size) * size, 1);
+    m.grid.cols = size;
+    m.grid.rows = size;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            bool field = x % 12 >= 2 && x % 12 < 10 && y % 9 >= 2 && y % 9 < 7 && (x / 12 + y / 9) % 3 != 0;
+            bool obstacle = rng() % 100 < 6;
+            if (field || obstacle) m.walkable[static_cast<std::size_t>(y) * size + x] = 0;
+        }
+    }
+    return m;
+}
+
+static std::vector<BenchMap> shippedLevels() {
+    std::vector<BenchMap> maps;
+    for (int level = 1; level <= 4; ++level) {
+        MatchRules rules;
+        rules.log = false;
+        GameSim sim(level, 1, rules);
+        if (!sim.isLevelLoaded()) continue;
+        BenchMap m;
+        m.name = "level " + std::to_string(level) + " (player side)";
+        m.walkable = sim.getGrid().walkable;
+        m.grid.cols = sim.getGridCols();
+        m.grid.rows = sim.getGridRows();
+        m.grid.endCol = sim.getLayout().playerCols;
+        maps.push_back(std::move(m));
+    }
+    return maps;
+}
+
+// False if the steady-state searches allocated
+static bool runMap(BenchMap& m, int queries, int clusterSize, std::mt19937& rng) {
+    PathGrid& g = m.grid;
+    g.walkable = m.walkable.data();
+    if (g.endCol == 0) g.endCol = g.cols;
+    WalkBits bits;
+    bits.build(g);
+    g.bits = &bits;
+
+    // queries between walkable tiles that are connected (checked with A*)
+    std::vector<std::pair<int, int>> pairs;
+    std::vector<int> open;
+    for (int i = 0; i < g.cols * g.rows; ++i) {
+        if (g.open(i % g.cols, i / g.cols)) open.push_back(i);
+    }
+    if (open.size() < 2) return true;
+    for (int tries = 0; static_cast<int>(pairs.size()) < queries && tries < queries * 20; ++tries) {
+        int s = open[rng() % open.size()];
+        int t = open[rng() % open.size()];
+        if (s != t && !findPath(PathAlgorithm::AStar, g, s, t).empty()) pairs.push_back({s, t});
+    }
+
+    std::cout << m.name << ": " << pairs.size() << " queries\n";
+    using Clock = std::chrono::steady_clock;
+    std::vector<int> reference, reference4;
+    for (PathAlgorithm a : { PathAlgorithm::AStar, PathAlgorithm::JumpPoint, PathAlgorithm::AStar8, PathAlgorithm::JumpPoint8 }) {
+        PathStats stats;
+        std::vector<int> costs;
+        auto start = Clock::now();
+        for (const auto& q : pairs) costs.push_back(pathCost(findPath(a, g, q.first, q.second, &stats), g.cols));
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        // JPS is checked against the A* with the same moves
+        if (a == PathAlgorithm::AStar || a == PathAlgorithm::AStar8) reference = costs;
+        if (a == PathAlgorithm::AStar) reference4 = costs;
+        const double n = static_cast<double>(pairs.size());
+        std::cout << "  " << std::left << std::setw(7) << pathAlgorithmName(a) << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(1) << stats.expanded / n << " expanded"
+                  << std::setw(12) << stats.scanned / n << " scanned"
+                  << std::setw(12) << std::setprecision(2) << us / n << " us/search"
+                  << (costs == reference ? "" : "  PATH COSTS DIFFER") << "\n";
+    }
+
+    // HPA*: the graph is built once, then searched
+    auto start = Clock::now();
+    HierarchicalPaths hpa;
+    hpa.build(g, clusterSize);
+    double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    PathStats stats;
+    long long cost = 0, optimal = 0;
+    start = Clock::now();
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        cost += pathCost(hpa.findPath(pairs[i].first, pairs[i].second, &stats), g.cols);
+        optimal += reference4[i];
+    }
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    // block a tile and free it again
+    const int tile = open[rng() % open.size()];
+    start = Clock::now();
+    m.walkable[static_cast<std::size_t>(tile)] = 0;
+    hpa.tileChanged(tile);
+    hpa.update();
+    double updateUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    m.walkable[static_cast<std::size_t>(tile)] = 1;
+    hpa.tileChanged(tile);
+    hpa.update();
+
+    const double n = static_cast<double>(pairs.size());
+    std::cout << "  " << std::left << std::setw(7) << pathAlgorithmName(PathAlgorithm::Hierarchical) << std::right
+              << std::setw(12) << std::setprecision(1) << stats.expanded / n << " expanded"
+              << std::setw(12) << stats.scanned / n << " scanned"
+              << std::setw(12) << std::setprecision(2) << us / n << " us/search"
+              << "  paths +" << std::setprecision(1) << 100.0 * (cost - optimal) / std::max(1LL, optimal) << "%"
+              << ", build " << std::setprecision(2) << buildMs << " ms (" << hpa.getNodeCount() << " nodes)"
+              << ", one tile changed: " << updateUs << " us\n";
+
+    // D* Lite: plan, walk a step, block a tile further along the path, repair
+    PathStats planStats, repairStats, againStats;
+    double planUs = 0.0, repairUs = 0.0, againUs = 0.0;
+    int repairs = 0;
+    for (const auto& q : pairs) {
+        DStarLite planner;
+        start = Clock::now();
+        planner.plan(g, q.first, q.second);
+        std::vector<int> path = planner.path(&planStats);
+        planUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        if (path.size() < 4) continue;
+
+        const int blocked = path[path.size() / 2];
+        m.walkable[static_cast<std::size_t>(blocked)] = 0;
+        bits.update(g, blocked);
+        start = Clock::now();
+        planner.moveTo(path[1]);
+        planner.tileChanged(blocked);
+        planner.path(&repairStats);
+        repairUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        start = Clock::now();
+        findPath(PathAlgorithm::AStar, g, path[1], q.second, &againStats);
+        againUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        m.walkable[static_cast<std::size_t>(blocked)] = 1;
+        bits.update(g, blocked);
+        repairs++;
+    }
+    const double r = std::max(1, repairs);
+    std::cout << "  " << std::left << std::setw(7) << pathAlgorithmName(PathAlgorithm::DStarLite) << std::right
+              << std::setw(12) << std::setprecision(1) << planStats.expanded / n << " expanded"
+              << std::setw(20) << " "
+              << std::setw(12) << std::setprecision(2) << planUs / n << " us/search"
+              << "  repair after a blocked tile: " << std::setprecision(1) << repairStats.expanded / r << " expanded, "
+              << std::setprecision(2) << repairUs / r << " us (A* again: " << std::setprecision(1) << againStats.expanded / r
+              << " expanded, " << std::setprecision(2) << againUs / r << " us)\n";
+
+    // A*, JPS and HPA* into one reused path: the first round warms up this thread's search memory and
+    // the path's storage, the second must not allocate
+    bool steady = true;
+    for (PathAlgorithm a : { PathAlgorithm::AStar, PathAlgorithm::AStar8, PathAlgorithm::JumpPoint, PathAlgorithm::JumpPoint8 }) {
+        std::vector<int> path;
+        for (const auto& q : pairs) findPath(a, g, q.first, q.second, path);
+        const std::uint64_t before = allocations;
+        start = Clock::now();
+        for (const auto& q : pairs) findPath(a, g, q.first, q.second, path);
+        us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        const std::uint64_t made = allocations - before;
+        std::cout << "  " << std::left << std::setw(7) << pathAlgorithmName(a) << std::right
+                  << std::setw(44) << std::setprecision(2) << us / n << " us/search"
+                  << "  reusing memory: " << made << " allocations" << (made ? "  ALLOCATES" : "") << "\n";
+        steady = steady && made == 0;
+    }
+    {
+        std::vector<int> path;
+        for (const auto& q : pairs) hpa.findPath(q.first, q.second, path);
+        const std::uint64_t before = allocations;
+        start = Clock::now();
+        for (const auto& q : pairs) hpa.findPath(q.first, q.second, path);
+        us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        const std::uint64_t made = allocations - before;
+        std::cout << "  " << std::left << std::setw(7) << pathAlgorithmName(PathAlgorithm::Hierarchical) << std::right
+                  << std::setw(44) << std::setprecision(2) << us / n << " us/search"
+                  << "  reusing memory: " << made << " allocations" << (made ? "  ALLOCATES" : "") << "\n";
+        steady = steady && made == 0;
+    }
+    {
+        // through a path cache a quarter the size of the queries, as GameSim searches: the
+        // walkability version moves on before each round, so every query misses and most
+        // push an older path out
+        PathCache cache(std::max(1, static_cast<int>(pairs.size()) / 4));
+        std::vector<int> path;
+        for (const auto& q : pairs) cache.findPath(PathAlgorithm::AStar, g, q.first, q.second, 1, path);
+        const PathCache::Stats warm = cache.getStats();
+        const std::uint64_t before = allocations;
+        start = Clock::now();
+        for (const auto& q : pairs) cache.findPath(PathAlgorithm::AStar, g, q.first, q.second, 2, path);
+        us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        const std::uint64_t made = allocations - before;
+        const PathCache::Stats after = cache.getStats();
+        std::cout << "  cached " << std::setw(44) << std::setprecision(2) << us / n << " us/search"
+                  << "  reusing memory: " << made << " allocations" << (made ? "  ALLOCATES" : "")
+                  << " (" << after.lookups - after.hits - (warm.lookups - warm.hits) << " misses, "
+                  << after.evictions - warm.evictions << " evictions)\n";
+        steady = steady && made == 0;
+    }
+
+    // any-angle smoothing of the A* paths: waypoints left, time on top of the search
+    std::vector<int> path;
+    std::size_t tiles = 0, corners = 0;
+    double smoothUs = 0.0;
+    for (const auto& q : pairs) {
+        findPath(PathAlgorithm::AStar, g, q.first, q.second, path);
+        tiles += path.size();
+        start = Clock::now();
+        smoothPath(g, path);
+        smoothUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        corners += path.size();
+    }
+    std::cout << "  smooth " << std::setw(44) << std::setprecision(2) << smoothUs / n << " us/path"
+              << "  waypoints " << std::setprecision(1) << tiles / n << " -> " << corners / n << "\n";
+    return steady;
+}
+
+// A path cached for one algorithm must never be handed out for another: cache the same
+// start and goal under every algorithm in turn, each lookup has to search again
+static bool checkCacheKeys() {
+    const int size = 32;
+    std::vector<std::uint8_t> walkable(static_cast<std::size_t>(size) * size, 1);
+    PathGrid g;
+    g.walkable = walkable.data();
+    g.cols = g.rows = g.endCol = size;
+
+    PathCache cache(16);
+    std::vector<int> path;
+    int searches = 0;
+    for (PathAlgorithm a : { PathAlgorithm::AStar, PathAlgorithm::Hierarchical, PathAlgorithm::AStar8, PathAlgorithm::DStarLite,
+                             PathAlgorithm::JumpPoint, PathAlgorithm::JumpPoint8 }) {
+        cache.findPath(a, g, 0, size * size - 1, 1, path, [&](std::vector<int>& out) { searches++; findPath(a, g, 0, size * size - 1, out); });
+    }
+    const bool apart = searches == 6 && cache.getStats().hits == 0;
+    std::cout << "path cache keys: " << (apart ? "one entry per algorithm" : "ALGORITHMS SHARE ENTRIES") << "\n";
+    return apart;
+}
+
+int main(int argc, char** argv) {
+    int queries = 200;
+    int clusterSize = HierarchicalPaths::defaultClusterSize;
+    std::uint32_t seed = 1;
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--queries" && hasValue) queries = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--size" && hasValue) sizes.push_back(std::atoi(argv[++i]));
+        else if (arg == "--cluster" && hasValue) clusterSize = std::atoi(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--queries Q] [--seed S] [--size N]... [--cluster C]\n";
+            return 1;
+        }
+    }
+    if (sizes.empty()) sizes = {256, 1024};
+
+    const bool keysApart = checkCacheKeys();
+    std::mt19937 rng(seed);
+    std::vector<BenchMap> maps = shippedLevels();
+    for (int size : sizes) maps.push_back(makeFarmMap(size, rng));
+    bool steady = true;
+    for (BenchMap& m : maps) steady = runMap(m, queries, clusterSize, rng) && steady;
+    return steady && keysApart ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include "pathCache.hpp"
+#include <algorithm>
+
+void PathCache::setCapacity(int capacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.assign(static_cast<std::size_t>(std::max(0, capacity)), Entry());
+    std::size_t n = entries.empty() ? 0 : 4;
+    while (n < 2 * entries.size()) n *= 2;
+    slots.assign(n, -1);
+    dropAll();
+}
+
+void PathCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    dropAll();
+}
+
+void PathCache::dropAll() {
+    std::fill(slots.begin(), slots.end(), -1);
+    used = 0;
+    head = -1;
+    tail = -1;
+}
+
+// Start and goal tile (20 bits each: grids are at most 1024x1024), the column range
+// (10 bits for the first column, 11 for the end) and the algorithm (3 bits)
+static_assert(static_cast<int>(PathAlgorithm::DStarLite) < 8, "the last PathAlgorithm must fit the key's 3 bits");
+
+std::uint64_t PathCache::makeKey(PathAlgorithm algorithm, const PathGrid& grid, int start, int goal) {
+    return static_cast<std::uint64_t>(start & 0xFFFFF)
+         | static_cast<std::uint64_t>(goal & 0xFFFFF) << 20
+         | static_cast<std::uint64_t>(grid.minCol & 0x3FF) << 40
+         | static_cast<std::uint64_t>(grid.endCol & 0x7FF) << 50
+         | static_cast<std::uint64_t>(algorithm) << 61;
+}
+
+std::size_t PathCache::home(std::uint64_t key) const {
+    // the key's fields sit in separate bit ranges: mix them before taking the low bits
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return static_cast<std::size_t>(key) & (slots.size() - 1);
+}
+
+int PathCache::find(std::uint64_t key) const {
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t i = home(key);; i = (i + 1) & mask) {
+        const int e = slots[i];
+        if (e < 0) return -1;
+        if (entries[static_cast<std::size_t>(e)].key == key) return e;
+    }
+}
+
+void PathCache::insertSlot(std::uint64_t key, int e) {
+    const std::size_t mask = slots.size() - 1;
+    std::size_t i = home(key);
+    while (slots[i] >= 0) i = (i + 1) & mask;
+    slots[i] = e;
+}
+
+// Free the key's slot, then move later entries of the probe run back over the gap so
+// every lookup still meets its entry before a free slot (no tombstones)
+void PathCache::eraseSlot(std::uint64_t key) {
+    const std::size_t mask = slots.size() - 1;
+    std::size_t gap = home(key);
+    while (entries[static_cast<std::size_t>(slots[gap])].key != key) gap = (gap + 1) & mask;
+    for (std::size_t i = (gap + 1) & mask; slots[i] >= 0; i = (i + 1) & mask) {
+        const std::size_t want = home(entries[static_cast<std::size_t>(slots[i])].key);
+        // the entry at i may fill the gap if its home isn't in (gap, i]
+        if (((i - want) & mask) >= ((i - gap) & mask)) {
+            slots[gap] = slots[i];
+            gap = i;
+        }
+    }
+    slots[gap] = -1;
+}
+
+void PathCache::unlink(int e) {
+    Entry& en = entries[static_cast<std::size_t>(e)];
+    if (en.prev >= 0) entries[static_cast<std::size_t>(en.prev)].next = en.next;
+    else head = en.next;
+    if (en.next >= 0) entries[static_cast<std::size_t>(en.next)].prev = en.prev;
+    else tail = en.prev;
+    en.prev = en.next = -1;
+}
+
+void PathCache::pushFront(int e) {
+    Entry& en = entries[static_cast<std::size_t>(e)];
+    en.prev = -1;
+    en.next = head;
+    if (head >= 0) entries[static_cast<std::size_t>(head)].prev = e;
+    head = e;
+    if (tail < 0) tail = e;
+}
+
+bool PathCache::lookup(std::uint64_t key, std::uint32_t walkVersion, std::vector<int>& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.lookups++;
+    if (walkVersion != version) {
+        if (used > 0) stats.invalidations++;
+        dropAll();
+        version = walkVersion;
+    }
+    const int e = find(key);
+    if (e < 0) return false;
+    stats.hits++;
+    stats.savedMicros += entries[static_cast<std::size_t>(e)].micros;
+    unlink(e);
+    pushFront(e);
+    path = entries[static_cast<std::size_t>(e)].path;
+    return true;
+}
+
+void PathCache::store(std::uint64_t key, std::uint32_t walkVersion, const std::vector<int>& path, float micros) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.searchMicros += micros;
+    // the grid changed during the search, or another thread found the same path first
+    if (walkVersion != version || find(key) >= 0) return;
+
+    int e;
+    if (used < static_cast<int>(entries.size())) {
+        e = used++;
+    } else {
+        e = tail;
+        unlink(e);
+        eraseSlot(entries[static_cast<std::size_t>(e)].key);
+        stats.evictions++;
+    }
+    Entry& en = entries[static_cast<std::size_t>(e)];
+    en.key = key;
+    en.path = path; // reuses the evicted entry's storage
+    en.micros = micros;
+    pushFront(e);
+    insertSlot(key, e);
+}
+
+PathCache::Stats PathCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include "gridPath.hpp"
+
+// The last few hundred path search results, keyed by start, goal and the movement rules
+// (algorithm and the columns a farmer may use), least recently used out first.
+// Paths are only valid for the walkability they were searched on: the cache is tagged
+// with the owner's walkability version and empties itself when that moves on.
+// Lookups and inserts may come from several threads at once (the AI's path phase).
+class PathCache {
+public:
+    // Lifetime counters
+    struct Stats {
+        std::uint64_t lookups = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t evictions = 0;     // entries pushed out by newer ones
+        std::uint64_t invalidations = 0; // times the cache was emptied by a walkability change
+        double searchMicros = 0.0;       // time spent in the searches that missed
+        double savedMicros = 0.0;        // what the hits took to search the first time
+
+        double hitRate() const { return lookups ? static_cast<double>(hits) / lookups : 0.0; }
+    };
+
+    explicit PathCache(int capacity = 0) { setCapacity(capacity); }
+
+    // Number of paths kept (0 turns the cache off); drops what's cached
+    void setCapacity(int capacity);
+    int getCapacity() const { return static_cast<int>(entries.size()); }
+    // Forget every path (keeps the capacity)
+    void clear();
+
+    // The path from the cache, or found with algorithm (and remembered), into path;
+    // false if the goal can't be reached. Reuses path's storage.
+    bool findPath(PathAlgorithm algorithm, const PathGrid& grid, int start, int goal,
+                  std::uint32_t walkVersion, std::vector<int>& path) {
+        return findPath(algorithm, grid, start, goal, walkVersion, path,
+                        [&](std::vector<int>& out) { ::findPath(algorithm, grid, start, goal, out); });
+    }
+    // Same, with search(path) doing the search (for searches that need more than the grid)
+    template <class Search>
+    bool findPath(PathAlgorithm algorithm, const PathGrid& grid, int start, int goal,
+                  std::uint32_t walkVersion, std::vector<int>& path, Search search) {
+        if (entries.empty()) {
+            search(path);
+            return !path.empty();
+        }
+        const std::uint64_t key = makeKey(algorithm, grid, start, goal);
+        if (lookup(key, walkVersion, path)) return !path.empty();
+
+        // searched outside the lock, other threads keep using the cache meanwhile
+        auto t0 = std::chrono::steady_clock::now();
+        search(path);
+        store(key, walkVersion, path, std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - t0).count());
+        return !path.empty();
+    }
+
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        std::uint64_t key = 0;
+        std::vector<int> path;
+        float micros = 0.f; // search time
+        int prev = -1;      // towards the most recently used
+        int next = -1;      // towards the least recently used
+    };
+
+    static std::uint64_t makeKey(PathAlgorithm algorithm, const PathGrid& grid, int start, int goal);
+    bool lookup(std::uint64_t key, std::uint32_t walkVersion, std::vector<int>& path);
+    void store(std::uint64_t key, std::uint32_t walkVersion, const std::vector<int>& path, float micros);
+    void unlink(int e);
+    void pushFront(int e);
+    void dropAll(); // with the lock held
+    // Key -> entry index: open addressing with linear probing in slots (a power of two,
+    // at least twice the capacity), so once the capacity is set nothing is allocated
+    int find(std::uint64_t key) const;
+    void insertSlot(std::uint64_t key, int e);
+    void eraseSlot(std::uint64_t key);
+    std::size_t home(std::uint64_t key) const;
+
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    std::vector<int> slots; // entry index, -1 if free
+    int used = 0;
+    int head = -1; // most recently used
+    int tail = -1; // least recently used
+    std::uint32_t version = 0;
+    Stats stats;
+};
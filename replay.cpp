@@ -0,0 +1,182 @@
+#include "replay.hpp"
+
+static const char replayMagic[4] = { 'F', 'R', 'P', 'L' };
+static constexpr std::uint8_t replayVersion = 1;
+
+static constexpr std::uint8_t speedCode = 0xF0;
+static constexpr std::uint8_t rewindCode = 0xF1;
+static constexpr std::uint8_t takeBit = 0x10;
+static constexpr std::uint8_t dropBit = 0x20;
+
+static std::uint8_t moveBits(const sf::Vector2f& move) {
+    return (move.x < 0.f ? 1 : 0) | (move.x > 0.f ? 2 : 0) | (move.y < 0.f ? 4 : 0) | (move.y > 0.f ? 8 : 0);
+}
+
+static sf::Vector2f moveFromBits(std::uint8_t bits) {
+    return { ((bits & 2) ? 1.f : 0.f) - ((bits & 1) ? 1.f : 0.f),
+             ((bits & 8) ? 1.f : 0.f) - ((bits & 4) ? 1.f : 0.f) };
+}
+
+// Recorder
+
+bool ReplayRecorder::open(const std::string& path, const GameSim& sim) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    out.write(replayMagic, sizeof(replayMagic));
+    out.put(static_cast<char>(replayVersion));
+    writeVarint(static_cast<std::uint32_t>(sim.getLevelID()));
+    std::uint32_t seed = sim.getSeed();
+    out.write(reinterpret_cast<const char*>(&seed), sizeof(seed));
+    float speed = sim.getPlayerSpeed();
+    out.write(reinterpret_cast<const char*>(&speed), sizeof(speed));
+
+    cursor = sim.getTick();
+    heldBits = 0;
+    return static_cast<bool>(out);
+}
+
+void ReplayRecorder::writeVarint(std::uint32_t v) {
+    while (v >= 0x80) { out.put(static_cast<char>(v | 0x80)); v >>= 7; }
+    out.put(static_cast<char>(v));
+}
+
+void ReplayRecorder::writeEvent(std::uint32_t tick, std::uint8_t code) {
+    writeVarint(tick - cursor);
+    out.put(static_cast<char>(code));
+    cursor = tick;
+}
+
+void ReplayRecorder::recordStep(const PlayerInput& input, std::uint32_t tick) {
+    if (!out.is_open()) return;
+    std::uint8_t bits = moveBits(input.move);
+    if (bits == heldBits && !input.take && !input.drop) return; // nothing new
+
+    writeEvent(tick, bits | (input.take ? takeBit : 0) | (input.drop ? dropBit : 0));
+    heldBits = bits;
+}
+
+void ReplayRecorder::recordSpeed(float speed, std::uint32_t tick) {
+    if (!out.is_open()) return;
+    writeEvent(tick, speedCode);
+    out.write(reinterpret_cast<const char*>(&speed), sizeof(speed));
+}
+
+void ReplayRecorder::recordRewind(std::uint32_t tick, std::uint32_t targetTick) {
+    if (!out.is_open()) return;
+    writeEvent(tick, rewindCode);
+    writeVarint(targetTick);
+    cursor = targetTick;
+}
+
+void ReplayRecorder::close(std::uint32_t tick) {
+    if (!out.is_open()) return;
+    writeEvent(tick, ReplayPlayer::endCode);
+    out.close();
+}
+
+// Player
+
+constexpr std::uint8_t ReplayPlayer::endCode;
+
+static bool readVarint(std::istream& in, std::uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int b = in.get();
+        if (b == EOF) return false;
+        v |= static_cast<std::uint32_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+bool ReplayPlayer::open(const std::string& path) {
+    in.open(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "[WARN] Replay not found: " << path << "\n";
+        return false;
+    }
+
+    char magic[4] = {};
+    in.read(magic, sizeof(magic));
+    int version = in.get();
+    if (!in || !std::equal(magic, magic + 4, replayMagic) || version != replayVersion) {
+        std::cerr << "[WARN] Not a replay file (or another version): " << path << "\n";
+        return false;
+    }
+
+    std::uint32_t level = 0;
+    readVarint(in, level);
+    in.read(reinterpret_cast<char*>(&seed), sizeof(seed));
+    in.read(reinterpret_cast<char*>(&playerSpeed), sizeof(playerSpeed));
+    if (!in) return false;
+    levelID = static_cast<int>(level);
+
+    finished = false;
+    cursor = 0;
+    held = PlayerInput();
+    rewind.reset();
+    readEvent();
+    return true;
+}
+
+// Read the next event into pending*; a truncated file simply has no more events
+bool ReplayPlayer::readEvent() {
+    havePending = false;
+    std::uint32_t delta = 0;
+    if (!readVarint(in, delta)) return false;
+    int code = in.get();
+    if (code == EOF) return false;
+
+    pendingTick = cursor + delta;
+    pendingCode = static_cast<std::uint8_t>(code);
+    if (pendingCode == speedCode) {
+        in.read(reinterpret_cast<char*>(&pendingSpeed), sizeof(pendingSpeed));
+    } else if (pendingCode == rewindCode) {
+        if (!readVarint(in, pendingTarget)) return false;
+    }
+    havePending = static_cast<bool>(in);
+    return havePending;
+}
+
+bool ReplayPlayer::step(GameSim& sim) {
+    if (finished) return false;
+
+    if (!rewind) {
+        sim.setPlayerSpeed(playerSpeed);
+        // keep more history than the game did, so every recorded rewind can be honoured
+        rewind.reset(new RewindBuffer(sim, 2.f * RewindBuffer::defaultSeconds));
+    }
+
+    PlayerInput input = held;
+    while (havePending && pendingTick <= sim.getTick()) {
+        cursor = pendingTick;
+        if (pendingCode == endCode) {
+            finished = true;
+            return false;
+        } else if (pendingCode == speedCode) {
+            sim.setPlayerSpeed(pendingSpeed);
+        } else if (pendingCode == rewindCode) {
+            if (!rewind->restore(sim, pendingTarget)) {
+                std::cerr << "[WARN] Replay rewinds to tick " << pendingTarget << " which is no longer kept\n";
+            }
+            cursor = pendingTarget;
+            input = held;
+        } else {
+            held.move = moveFromBits(pendingCode & 0x0F);
+            input = held;
+            input.take = (pendingCode & takeBit) != 0;
+            input.drop = (pendingCode & dropBit) != 0;
+        }
+        readEvent();
+    }
+
+    if (sim.isGameOver()) {
+        finished = true;
+        return false;
+    }
+
+    sim.step(input);
+    rewind->capture(sim);
+    return true;
+}
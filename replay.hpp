@@ -0,0 +1,76 @@
+#pragma once
+#include <fstream>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "gameSim.hpp"
+#include "snapshot.hpp"
+
+// Replay file: a header (magic, version, level, seed, player speed) and then a stream
+// of events, each written as "ticks since the previous event (varint), event code".
+// Inputs are only written when they change, so long holds and idle stretches are free.
+//   0x00-0x3F  input from this tick on: bits 0-3 left/right/up/down held,
+//              bit 4 take, bit 5 drop (those two only for this tick)
+//   0xF0       player speed change, float follows
+//   0xF1       rewind, varint target tick follows (ticks of later events count from it)
+//   0xFF       end of the match (a file cut short just ends at its last event)
+// With the same level, seed and events GameSim replays the match step for step.
+
+class ReplayRecorder {
+public:
+    // Start a file for this match (sim freshly constructed); false if it cannot be written
+    bool open(const std::string& path, const GameSim& sim);
+    bool isOpen() const { return out.is_open(); }
+
+    // Call right before sim.step with the input that step gets
+    void recordStep(const PlayerInput& input, std::uint32_t tick);
+    void recordSpeed(float speed, std::uint32_t tick);
+    // The sim was put back from tick to targetTick
+    void recordRewind(std::uint32_t tick, std::uint32_t targetTick);
+    void close(std::uint32_t tick);
+
+private:
+    void writeEvent(std::uint32_t tick, std::uint8_t code);
+    void writeVarint(std::uint32_t v);
+
+    std::ofstream out;
+    std::uint32_t cursor = 0;    // tick of the last event
+    std::uint8_t heldBits = 0;   // movement bits last written
+};
+
+class ReplayPlayer {
+public:
+    static constexpr std::uint8_t endCode = 0xFF;
+
+    bool open(const std::string& path);
+
+    int getLevelID() const { return levelID; }
+    std::uint32_t getSeed() const { return seed; }
+    float getPlayerSpeed() const { return playerSpeed; }
+
+    // Apply the events due at the sim's current tick and advance it one step. The sim
+    // must be built as GameSim(getLevelID(), getSeed()); the first step sets its speed.
+    // Returns false once the replay is over (end event, end of file or game over).
+    bool step(GameSim& sim);
+    bool isFinished() const { return finished; }
+
+private:
+    bool readEvent();
+
+    std::ifstream in;
+    int levelID = 1;
+    std::uint32_t seed = 0;
+    float playerSpeed = 200.f;
+
+    bool finished = false;
+    bool havePending = false;
+    std::uint32_t pendingTick = 0;
+    std::uint8_t pendingCode = 0;
+    float pendingSpeed = 0.f;
+    std::uint32_t pendingTarget = 0;
+    std::uint32_t cursor = 0;
+    PlayerInput held;
+
+    // recorded rewinds are replayed from our own history of the match
+    std::unique_ptr<RewindBuffer> rewind;
+};
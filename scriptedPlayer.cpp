@@ -0,0 +1,117 @@
+#include "scriptedPlayer.hpp"
+
+// Most needed crop of the current request (same choice the AI makes)
+CropType ScriptedPlayer::wantedCrop(const GameSim& sim) {
+    return sim.getOrders().mostWanted();
+}
+
+bool ScriptedPlayer::accepts(const GameSim& sim, Goal g, CropType crop, int tile) const {
+    const FarmGrid& grid = sim.getGrid();
+    switch (g) {
+        case Goal::Seeds:  return grid.type[tile] == GroundType::Seeds && grid.crop[tile] == crop;
+        case Goal::Soil:   return grid.type[tile] == GroundType::Soil && sim.tileState(tile) == TileState::Empty;
+        case Goal::Crop:   return tile == plantedTile;
+        case Goal::Market: return grid.type[tile] == GroundType::Market;
+        default:           return false;
+    }
+}
+
+bool ScriptedPlayer::planPath(const GameSim& sim, Goal g, CropType crop) {
+    const FarmGrid& grid = sim.getGrid();
+    const GridLayout& layout = sim.getLayout();
+    const int cols = grid.cols;
+    const int rows = grid.rows;
+
+    // columns whose centre keeps the whole farmer left of the divider
+    const float r = sim.getPlayer().radius;
+    const int maxCol = static_cast<int>((layout.wallLeft - r) / layout.tileSize.x - 0.5f);
+
+    path.clear();
+    pathIndex = 0;
+    goalTile = -1;
+
+    int start = sim.tileIndexFromPos(sim.getPlayer().position);
+    if (start < 0) return false;
+
+    std::vector<int> cameFrom(grid.size(), -2);
+    std::vector<int> frontier;
+    frontier.push_back(start);
+    cameFrom[start] = -1;
+
+    for (size_t head = 0; head < frontier.size(); ++head) {
+        int cur = frontier[head];
+        if (accepts(sim, g, crop, cur)) { goalTile = cur; break; }
+
+        int cx = cur % cols, cy = cur / cols;
+        const int dx[4] = { 1, -1, 0, 0 };
+        const int dy[4] = { 0, 0, 1, -1 };
+        for (int k = 0; k < 4; ++k) {
+            int nx = cx + dx[k], ny = cy + dy[k];
+            if (nx < 0 || nx > maxCol || nx >= cols || ny < 0 || ny >= rows) continue;
+            int n = ny * cols + nx;
+            if (cameFrom[n] != -2 || !grid.walkable[n]) continue;
+            cameFrom[n] = cur;
+            frontier.push_back(n);
+        }
+    }
+    if (goalTile < 0) return false;
+
+    for (int t = goalTile; t != -1; t = cameFrom[t]) path.push_back(t);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+PlayerInput ScriptedPlayer::think(const GameSim& sim) {
+    PlayerInput input;
+    const Farmer& me = sim.getPlayer();
+
+    // our planted tile is the next goal once it is grown; until then just wait
+    if (plantedTile >= 0 && sim.tileState(plantedTile) == TileState::Empty) plantedTile = -1;
+
+    Goal want = Goal::None;
+    CropType crop = CropType::None;
+    if (me.hasProduct) want = Goal::Market;
+    else if (me.hasSeed) want = Goal::Soil;
+    else if (plantedTile >= 0) want = sim.tileState(plantedTile) == TileState::Grown ? Goal::Crop : Goal::None;
+    else if ((crop = wantedCrop(sim)) != CropType::None) want = Goal::Seeds;
+
+    if (retryDelay > 0) { retryDelay--; return input; }
+
+    if (want != goal || (want != Goal::None && path.empty())) {
+        goal = want;
+        path.clear();
+        if (goal != Goal::None && !planPath(sim, goal, crop)) {
+            goal = Goal::None;
+            retryDelay = 60; // nothing reachable on our side: look again in half a second
+        }
+    }
+    if (goal == Goal::None) return input;
+
+    // follow the path; on the last tile, act
+    int target = path[pathIndex];
+    sf::Vector2f to = sim.tileCenter(target) - me.position;
+    float dist = std::sqrt(to.x * to.x + to.y * to.y);
+
+    if (dist < 4.f) {
+        if (pathIndex + 1 < static_cast<int>(path.size())) {
+            pathIndex++;
+        } else {
+            if (goal == Goal::Seeds || goal == Goal::Crop) input.take = true;
+            else input.drop = true;
+            if (goal == Goal::Soil) plantedTile = target;
+            goal = Goal::None;
+            path.clear();
+        }
+        return input;
+    }
+    input.move = to / dist;
+
+    // walked into something: plan again from where we are
+    if (me.position == lastPos) {
+        if (++stuckSteps > 30) { path.clear(); goal = Goal::None; stuckSteps = 0; }
+    } else {
+        stuckSteps = 0;
+    }
+    lastPos = me.position;
+    return input;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include "gameSim.hpp"
+
+// Stand-in for the human in headless matches: plays the left side with the same loop a
+// person does (seed for the current request -> plant -> harvest -> market), steering
+// only through PlayerInput so it goes through exactly the same rules as the keyboard.
+class ScriptedPlayer {
+public:
+    // Input for the next step
+    PlayerInput think(const GameSim& sim);
+
+private:
+    enum class Goal { None, Seeds, Soil, Crop, Market };
+
+    Goal goal = Goal::None;
+    int goalTile = -1;
+    int plantedTile = -1; // our crop, while it grows
+    std::vector<int> path;
+    int pathIndex = 0;
+
+    sf::Vector2f lastPos{-1.f, -1.f};
+    int stuckSteps = 0;
+    int retryDelay = 0;
+
+    // breadth-first search from the tile under us to the nearest tile the goal accepts
+    bool planPath(const GameSim& sim, Goal g, CropType crop);
+    bool accepts(const GameSim& sim, Goal g, CropType crop, int tile) const;
+    static CropType wantedCrop(const GameSim& sim);
+};
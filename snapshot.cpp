@@ -0,0 +1,282 @@
+#include "snapshot.hpp"
+#include "gameSim.hpp"
+
+constexpr float RewindBuffer::defaultSeconds;
+
+RewindBuffer::RewindBuffer(const GameSim& sim, float seconds, int keyframeInterval)
+    : keyframeInterval(std::max(1, keyframeInterval)) {
+    const int tiles = sim.getGrid().size();
+
+    // size of the state image right now, plus room for the longest possible path of every AI farmer
+    std::size_t probeSize = 4096;
+    for (;;) {
+        curState.assign(probeSize, 0);
+        ByteWriter probe(curState.data(), curState.size());
+        sim.writeState(probe);
+        if (!probe.overflow) { probeSize = probe.size; break; }
+        probeSize *= 2;
+    }
+    const std::size_t pathBytes = static_cast<std::size_t>(tiles) * sizeof(std::int32_t);
+    const std::size_t stateCap = probeSize + sim.getAgents().size() * pathBytes + 1024;
+    prevState.assign(stateCap, 0);
+    curState.assign(stateCap, 0);
+
+    // worst cases: a keyframe, or a delta where every byte changed and every tile is dirty
+    const std::size_t tileBytes = static_cast<std::size_t>(tiles) * GameSim::tileSnapshotBytes;
+    const std::size_t keyframeBytes = 16 + stateCap + tileBytes;
+    const std::size_t deltaBytes = 16 + 2 * stateCap + tileBytes + static_cast<std::size_t>(tiles) * 5;
+    recordBuf.assign(std::max(keyframeBytes, deltaBytes), 0);
+
+    // enough for the requested history with typical (small) deltas; a busier match keeps less.
+    // Every walking AI farmer adds its two positions to each delta.
+    const int ticks = std::max(1, static_cast<int>(seconds / GameSim::fixedStep + 0.5f));
+    const int segments = ticks / this->keyframeInterval + 2;
+    const std::size_t typicalDelta = 256 + sim.getAgents().size() * 64;
+    arena.assign(segments * keyframeBytes + static_cast<std::size_t>(ticks) * typicalDelta, 0);
+    records.assign(ticks + this->keyframeInterval + 1, Record());
+}
+
+std::uint32_t RewindBuffer::getOldestTick() const {
+    return recordCount ? recordAt(0).tick : 0;
+}
+
+std::uint32_t RewindBuffer::getNewestTick() const {
+    return recordCount ? recordAt(recordCount - 1).tick : 0;
+}
+
+std::size_t RewindBuffer::getBytesUsed() const {
+    std::size_t total = 0;
+    for (int i = 0; i < recordCount; ++i) total += recordAt(i).length;
+    return total;
+}
+
+bool RewindBuffer::capture(GameSim& sim) {
+    ByteWriter state(curState.data(), curState.size());
+    sim.writeState(state);
+    if (state.overflow) {
+        sim.clearDirtyTiles();
+        forceKeyframe = true;
+        return false;
+    }
+
+    bool keyframe = forceKeyframe || recordCount == 0 || ticksSinceKeyframe + 1 >= keyframeInterval;
+    std::size_t length = 0, offset = 0;
+    bool stored = false;
+
+    for (int attempt = 0; attempt < 2 && !stored; ++attempt) {
+        if (!encodeRecord(sim, keyframe, state.size, length)) break;
+        if (reserve(length, keyframe, offset)) { stored = true; break; }
+        if (keyframe) break; // does not fit even in an empty ring
+        keyframe = true;     // the delta's keyframe had to go: start a new segment instead
+    }
+    sim.clearDirtyTiles();
+
+    if (!stored) {
+        forceKeyframe = true;
+        return false;
+    }
+
+    std::memcpy(arena.data() + offset, recordBuf.data(), length);
+    Record& r = records[(head + recordCount) % records.size()];
+    r.tick = sim.getTick();
+    r.offset = offset;
+    r.length = length;
+    r.keyframe = keyframe;
+    recordCount++;
+    lastRecordBytes = length;
+
+    if (keyframe) { keyframeCount++; ticksSinceKeyframe = 0; }
+    else ticksSinceKeyframe++;
+    forceKeyframe = false;
+
+    std::swap(prevState, curState); // swaps buffers, no copy
+    prevSize = state.size;
+    return true;
+}
+
+bool RewindBuffer::encodeRecord(GameSim& sim, bool keyframe, std::size_t stateSize, std::size_t& length) {
+    ByteWriter out(recordBuf.data(), recordBuf.size());
+    out.put<std::uint8_t>(keyframe ? 1 : 0);
+    out.put<std::uint32_t>(sim.getTick());
+
+    if (keyframe) {
+        out.putVarint(static_cast<std::uint32_t>(stateSize));
+        out.putBytes(curState.data(), stateSize);
+        for (int i = 0; i < sim.getGrid().size(); ++i) sim.writeTile(out, i);
+    } else {
+        encodeDelta(prevState.data(), prevSize, curState.data(), stateSize, out);
+        const std::vector<int>& dirty = sim.getDirtyTiles();
+        out.putVarint(static_cast<std::uint32_t>(dirty.size()));
+        for (int i : dirty) {
+            out.putVarint(static_cast<std::uint32_t>(i));
+            sim.writeTile(out, i);
+        }
+    }
+
+    length = out.size;
+    return !out.overflow;
+}
+
+// Find room for a record at the end of the ring, dropping old segments as needed.
+// A delta may not drop its own segment (it would lose its keyframe).
+bool RewindBuffer::reserve(std::size_t length, bool keyframe, std::size_t& offset) {
+    if (length > arena.size()) return false;
+
+    for (;;) {
+        if (recordCount == 0) { offset = 0; return true; }
+
+        if (recordCount < static_cast<int>(records.size())) {
+            const Record& first = recordAt(0);
+            const Record& last = recordAt(recordCount - 1);
+            std::size_t tail = last.offset + last.length;
+            bool wrapped = last.offset < first.offset;
+
+            if (!wrapped) {
+                if (tail + length <= arena.size()) { offset = tail; return true; }
+                if (length <= first.offset) { offset = 0; return true; }
+            } else if (tail + length <= first.offset) {
+                offset = tail;
+                return true;
+            }
+        }
+
+        if (!keyframe && keyframeCount <= 1) return false;
+        dropOldestSegment();
+    }
+}
+
+bool RewindBuffer::decodeRecords(int key, int target, GameSim* sim, int tiles) {
+    for (int i = key; i <= target; ++i) {
+        const Record& r = recordAt(i);
+        ByteReader in(arena.data() + r.offset, r.length);
+        bool isKey = in.get<std::uint8_t>() != 0;
+        in.get<std::uint32_t>();
+
+        if (isKey) {
+            std::size_t n = in.getVarint();
+            if (n > prevState.size()) return false;
+            in.getBytes(prevState.data(), n);
+            prevSize = n;
+            if (!sim) in.skip(static_cast<std::size_t>(tiles) * GameSim::tileSnapshotBytes);
+            for (int t = 0; sim && t < tiles; ++t) {
+                if (!sim->readTile(in, t)) return false;
+            }
+        } else {
+            std::size_t n = 0;
+            if (!applyDelta(prevState.data(), prevSize, in, curState.data(), curState.size(), n)) return false;
+            std::swap(prevState, curState);
+            prevSize = n;
+            std::uint32_t count = in.getVarint();
+            for (std::uint32_t k = 0; k < count && in.ok; ++k) {
+                int t = static_cast<int>(in.getVarint());
+                if (t < 0 || t >= tiles) return false;
+                if (!sim) in.skip(GameSim::tileSnapshotBytes);
+                else if (!sim->readTile(in, t)) return false;
+            }
+        }
+        if (!in.ok) return false;
+    }
+    return true;
+}
+
+void RewindBuffer::dropOldestSegment() {
+    do {
+        if (recordAt(0).keyframe) keyframeCount--;
+        head = (head + 1) % static_cast<int>(records.size());
+        recordCount--;
+    } while (recordCount > 0 && !recordAt(0).keyframe);
+}
+
+bool RewindBuffer::restore(GameSim& sim, std::uint32_t tick) {
+    if (recordCount == 0 || tick < getOldestTick() || tick > getNewestTick()) return false;
+
+    // last record at or before tick, and the keyframe its segment starts with
+    int target = recordCount - 1;
+    while (target > 0 && recordAt(target).tick > tick) --target;
+    int key = target;
+    while (key > 0 && !recordAt(key).keyframe) --key;
+    if (!recordAt(key).keyframe) return false;
+
+    const int tiles = sim.getGrid().size();
+
+    // check everything first, then decode again and apply; prevState is overwritten
+    // either way, so after a failure the next capture has to be a keyframe
+    bool valid = decodeRecords(key, target, nullptr, tiles);
+    if (valid) {
+        ByteReader state(prevState.data(), prevSize);
+        valid = sim.checkState(state);
+    }
+    if (!valid || !decodeRecords(key, target, &sim, tiles)) {
+        forceKeyframe = true;
+        return false;
+    }
+    ByteReader state(prevState.data(), prevSize);
+    if (!sim.readState(state)) return false;
+    sim.clearDirtyTiles();
+
+    // the future after this tick is gone; the next capture continues the segment
+    recordCount = target + 1;
+    keyframeCount = 0;
+    for (int i = 0; i < recordCount; ++i) {
+        if (recordAt(i).keyframe) keyframeCount++;
+    }
+    ticksSinceKeyframe = target - key;
+    forceKeyframe = false;
+    return true;
+}
+
+// Delta format: total length, then (unchanged run, changed run, changed bytes) triples.
+// Changed runs absorb gaps of fewer than 4 equal bytes, which are cheaper to copy.
+void RewindBuffer::encodeDelta(const std::uint8_t* prev, std::size_t prevLen,
+                               const std::uint8_t* cur, std::size_t curLen, ByteWriter& out) {
+    out.putVarint(static_cast<std::uint32_t>(curLen));
+
+    std::size_t i = 0;
+    while (i < curLen) {
+        std::size_t start = i;
+        while (i < curLen && i < prevLen && cur[i] == prev[i]) ++i;
+        std::size_t skip = i - start;
+        if (i >= curLen) {
+            out.putVarint(static_cast<std::uint32_t>(skip));
+            out.putVarint(0);
+            break;
+        }
+
+        std::size_t runStart = i;
+        std::size_t equal = 0;
+        while (i < curLen) {
+            bool same = i < prevLen && cur[i] == prev[i];
+            equal = same ? equal + 1 : 0;
+            ++i;
+            if (equal == 4) break;
+        }
+        std::size_t runEnd = i - equal;
+
+        out.putVarint(static_cast<std::uint32_t>(skip));
+        out.putVarint(static_cast<std::uint32_t>(runEnd - runStart));
+        out.putBytes(cur + runStart, runEnd - runStart);
+        i = runEnd;
+    }
+}
+
+bool RewindBuffer::applyDelta(const std::uint8_t* prev, std::size_t prevLen, ByteReader& in,
+                              std::uint8_t* out, std::size_t outCap, std::size_t& outLen) {
+    std::size_t curLen = in.getVarint();
+    if (!in.ok || curLen > outCap) return false;
+
+    std::size_t pos = 0;
+    while (pos < curLen) {
+        std::size_t skip = in.getVarint();
+        std::size_t copy = in.getVarint();
+        if (!in.ok || (skip == 0 && copy == 0)) return false;
+        if (pos + skip > curLen || pos + skip > prevLen) return false;
+        std::memcpy(out + pos, prev + pos, skip);
+        pos += skip;
+        if (pos + copy > curLen) return false;
+        in.getBytes(out + pos, copy);
+        pos += copy;
+    }
+
+    outLen = curLen;
+    return in.ok;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+class GameSim;
+
+// Appends raw little-endian values to a caller-owned buffer; never allocates.
+// Writing past the end only sets overflow, so the caller checks once at the end.
+struct ByteWriter {
+    std::uint8_t* data = nullptr;
+    std::size_t capacity = 0;
+    std::size_t size = 0;
+    bool overflow = false;
+
+    ByteWriter(std::uint8_t* d, std::size_t cap) : data(d), capacity(cap) {}
+
+    void putBytes(const void* src, std::size_t n) {
+        if (size + n > capacity) { overflow = true; return; }
+        std::memcpy(data + size, src, n);
+        size += n;
+    }
+    template <typename T> void put(const T& v) { putBytes(&v, sizeof(T)); }
+
+    // 7 bits per byte, small numbers take one byte
+    void putVarint(std::uint32_t v) {
+        while (v >= 0x80) { put(static_cast<std::uint8_t>(v | 0x80)); v >>= 7; }
+        put(static_cast<std::uint8_t>(v));
+    }
+};
+
+// Reads what ByteWriter wrote; running off the end clears ok and returns zeros
+struct ByteReader {
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    std::size_t pos = 0;
+    bool ok = true;
+
+    ByteReader(const std::uint8_t* d, std::size_t n) : data(d), size(n) {}
+
+    void getBytes(void* dst, std::size_t n) {
+        if (pos + n > size) { ok = false; std::memset(dst, 0, n); return; }
+        std::memcpy(dst, data + pos, n);
+        pos += n;
+    }
+    template <typename T> T get() { T v; getBytes(&v, sizeof(T)); return v; }
+    void skip(std::size_t n) {
+        if (pos + n > size) { ok = false; return; }
+        pos += n;
+    }
+
+    std::uint32_t getVarint() {
+        std::uint32_t v = 0;
+        for (int shift = 0; shift < 35 && ok; shift += 7) {
+            std::uint8_t b = get<std::uint8_t>();
+            v |= static_cast<std::uint32_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) break;
+        }
+        return v;
+    }
+};
+
+// Rewind history of a match: one record per captured step, kept in a fixed byte ring.
+// Every keyframeInterval ticks a record holds the whole match; the ones in between
+// hold only what changed since the previous record (the bytes of the state image that
+// differ, and the tiles the sim marked dirty). When the ring is full the oldest
+// keyframe and its deltas are dropped together.
+// All memory is reserved in the constructor; capture never allocates.
+class RewindBuffer {
+public:
+    static constexpr float defaultSeconds = 10.f;
+
+    RewindBuffer(const GameSim& sim, float seconds, int keyframeInterval = 120);
+
+    // Record the sim as it is now (call once after every step). Returns false if the
+    // record did not fit; the next capture is then forced to be a keyframe.
+    bool capture(GameSim& sim);
+
+    // Put the sim back to a recorded tick and drop the history after it. The records are
+    // checked before anything is applied: if they're damaged the sim is left as it was.
+    bool restore(GameSim& sim, std::uint32_t tick);
+
+    bool empty() const { return recordCount == 0; }
+    std::uint32_t getOldestTick() const;
+    std::uint32_t getNewestTick() const;
+
+    // Stats
+    std::size_t getBytesUsed() const;
+    std::size_t getCapacityBytes() const { return arena.size(); }
+    std::size_t getLastRecordBytes() const { return lastRecordBytes; }
+    std::size_t getStateBytes() const { return prevSize; }
+
+private:
+    struct Record {
+        std::uint32_t tick = 0;
+        std::size_t offset = 0;
+        std::size_t length = 0;
+        bool keyframe = false;
+    };
+
+    int keyframeInterval;
+    int ticksSinceKeyframe = 0;
+    bool forceKeyframe = true;
+
+    std::vector<std::uint8_t> arena;   // record bytes, used as a ring
+    std::vector<Record> records;       // ring of record descriptors
+    int head = 0;                      // oldest record
+    int recordCount = 0;
+    std::size_t lastRecordBytes = 0;
+
+    // state images (the last captured one, and the one being built or decoded)
+    // and the record being encoded before it is copied into the arena
+    std::vector<std::uint8_t> prevState, curState, recordBuf;
+    std::size_t prevSize = 0;
+    int keyframeCount = 0;
+
+    const Record& recordAt(int i) const { return records[(head + i) % records.size()]; }
+    bool encodeRecord(GameSim& sim, bool keyframe, std::size_t stateSize, std::size_t& length);
+    bool reserve(std::size_t length, bool keyframe, std::size_t& offset);
+    void dropOldestSegment();
+    // Decode records [key, target] into prevState, reading their tiles into sim (only
+    // checking them if sim is null)
+    bool decodeRecords(int key, int target, GameSim* sim, int tiles);
+
+    static void encodeDelta(const std::uint8_t* prev, std::size_t prevLen,
+                            const std::uint8_t* cur, std::size_t curLen, ByteWriter& out);
+    static bool applyDelta(const std::uint8_t* prev, std::size_t prevLen, ByteReader& in,
+                           std::uint8_t* out, std::size_t outCap, std::size_t& outLen);
+};
@@ -0,0 +1,134 @@
+#include "targetIndex.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+constexpr int TargetIndex::chunkSize;
+constexpr int TargetIndex::cropCount;
+constexpr int TargetIndex::bucketCount;
+
+int TargetIndex::bucketFor(TargetKind kind, CropType crop) {
+    int c = (kind == TargetKind::Seeds || kind == TargetKind::Grown) ? static_cast<int>(crop) : 0;
+    return static_cast<int>(kind) * cropCount + c;
+}
+
+// Which bucket a tile belongs in right now (-1 = none)
+int TargetIndex::classify(const FarmGrid& grid, int tile) {
+    if (!grid.walkable[tile]) return -1;
+    switch (grid.type[tile]) {
+        case GroundType::Seeds:
+            if (grid.crop[tile] == CropType::None) return -1;
+            return bucketFor(TargetKind::Seeds, grid.crop[tile]);
+        case GroundType::Market:
+            return bucketFor(TargetKind::Market, CropType::None);
+        case GroundType::Trash:
+            return bucketFor(TargetKind::Trash, CropType::None);
+        case GroundType::Soil:
+            if (grid.state[tile] == TileState::Empty) return bucketFor(TargetKind::EmptySoil, CropType::None);
+            if (grid.state[tile] == TileState::Grown) return bucketFor(TargetKind::Grown, grid.crop[tile]);
+            return -1;
+        default:
+            return -1;
+    }
+}
+
+int TargetIndex::chunkOf(int tile) const {
+    return (tile / cols / chunkSize) * chunkCols + (tile % cols) / chunkSize;
+}
+
+void TargetIndex::build(const FarmGrid& grid, float tileWidth, float tileHeight) {
+    cols = grid.cols;
+    rows = grid.rows;
+    tileW = tileWidth;
+    tileH = tileHeight;
+    chunkCols = (cols + chunkSize - 1) / chunkSize;
+    chunkRows = (rows + chunkSize - 1) / chunkSize;
+
+    members.assign(static_cast<std::size_t>(bucketCount) * chunkCols * chunkRows, std::vector<int>());
+    bucketTotals.assign(bucketCount, 0);
+    bucketOf.assign(grid.size(), -1);
+    slotOf.assign(grid.size(), -1);
+
+    for (int i = 0; i < grid.size(); ++i) {
+        int b = classify(grid, i);
+        if (b >= 0) add(b, i);
+    }
+}
+
+void TargetIndex::update(const FarmGrid& grid, int tile) {
+    if (tile < 0 || tile >= static_cast<int>(bucketOf.size())) return;
+    int b = classify(grid, tile);
+    if (b == bucketOf[tile]) return;
+    if (bucketOf[tile] >= 0) remove(tile);
+    if (b >= 0) add(b, tile);
+}
+
+void TargetIndex::add(int bucket, int tile) {
+    auto& list = members[static_cast<std::size_t>(bucket) * chunkCols * chunkRows + chunkOf(tile)];
+    bucketOf[tile] = static_cast<std::int8_t>(bucket);
+    slotOf[tile] = static_cast<int>(list.size());
+    list.push_back(tile);
+    bucketTotals[bucket]++;
+}
+
+void TargetIndex::remove(int tile) {
+    int bucket = bucketOf[tile];
+    auto& list = members[static_cast<std::size_t>(bucket) * chunkCols * chunkRows + chunkOf(tile)];
+    int slot = slotOf[tile];
+    list[slot] = list.back(); // swap-remove, order does not matter
+    slotOf[list[slot]] = slot;
+    list.pop_back();
+    bucketOf[tile] = -1;
+    slotOf[tile] = -1;
+    bucketTotals[bucket]--;
+}
+
+int TargetIndex::count(TargetKind kind, CropType crop) const {
+    if (bucketTotals.empty()) return 0;
+    return bucketTotals[bucketFor(kind, crop)];
+}
+
+int TargetIndex::nearest(TargetKind kind, CropType crop, const sf::Vector2f& pos, int minCol, int endCol,
+                         const int* areaOf, int area) const {
+    if (bucketTotals.empty()) return -1;
+    int bucket = bucketFor(kind, crop);
+    if (bucketTotals[bucket] == 0) return -1;
+
+    const float chunkW = chunkSize * tileW;
+    const float chunkH = chunkSize * tileH;
+    const float ringStep = std::min(chunkW, chunkH);
+    const int cx = std::max(0, std::min(chunkCols - 1, static_cast<int>(pos.x / chunkW)));
+    const int cy = std::max(0, std::min(chunkRows - 1, static_cast<int>(pos.y / chunkH)));
+    const int minChunkCol = minCol / chunkSize;
+    const int endChunkCol = std::min(chunkCols, endCol > cols ? chunkCols : (endCol + chunkSize - 1) / chunkSize);
+    const std::vector<int>* lists = &members[static_cast<std::size_t>(bucket) * chunkCols * chunkRows];
+
+    int best = -1;
+    float bestD = std::numeric_limits<float>::max();
+    const int maxRing = std::max(chunkCols, chunkRows);
+
+    for (int r = 0; r <= maxRing; ++r) {
+        // every chunk of this ring is at least (r - 1) chunks away from pos
+        if (best >= 0 && r > 0) {
+            float bound = (r - 1) * ringStep;
+            if (bound * bound > bestD) break;
+        }
+        for (int y = cy - r; y <= cy + r; ++y) {
+            if (y < 0 || y >= chunkRows) continue;
+            // top and bottom rows of the ring are walked fully, the others only at both ends
+            int xStep = (r == 0 || y == cy - r || y == cy + r) ? 1 : 2 * r;
+            for (int x = cx - r; x <= cx + r; x += xStep) {
+                if (x < minChunkCol || x >= endChunkCol) continue;
+                for (int t : lists[y * chunkCols + x]) {
+                    int col = t % cols;
+                    if (col < minCol || col >= endCol || (areaOf && areaOf[t] != area)) continue;
+                    float dx = (col + 0.5f) * tileW - pos.x;
+                    float dy = (t / cols + 0.5f) * tileH - pos.y;
+                    float d = dx * dx + dy * dy;
+                    if (d < bestD || (d == bestD && t < best)) { bestD = d; best = t; }
+                }
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "farmGrid.hpp"
+
+// What the AI goes looking for on the farm
+enum class TargetKind : std::uint8_t { Seeds, Market, Trash, EmptySoil, Grown };
+
+// Walkable tiles filed by (kind, crop) and by 16x16-tile chunk, so a nearest-tile query
+// only visits tiles of the wanted kind, ring by ring outwards from the asker.
+// Tiles are re-filed when they change (update), never when they are queried.
+class TargetIndex {
+public:
+    static constexpr int chunkSize = 16;
+
+    // File every tile of the grid (call after the grid is loaded or resized)
+    void build(const FarmGrid& grid, float tileW, float tileH);
+
+    // Re-file one tile after its state, crop or walkability changed
+    void update(const FarmGrid& grid, int tile);
+
+    // Nearest filed tile of that kind (crop only matters for Seeds / Grown) whose column
+    // is in [minCol, endCol), by straight-line distance between tile centre and pos, not
+    // by path length. With areaOf given, only tiles t with areaOf[t] == area count (the
+    // ones the asker can reach, say). Ties go to the lower index. Returns -1 if there is none.
+    int nearest(TargetKind kind, CropType crop, const sf::Vector2f& pos, int minCol = 0,
+                int endCol = std::numeric_limits<int>::max(), const int* areaOf = nullptr, int area = -1) const;
+
+    // Number of filed tiles of that kind
+    int count(TargetKind kind, CropType crop = CropType::None) const;
+
+private:
+    static constexpr int cropCount = 6;
+    static constexpr int bucketCount = 5 * cropCount;
+
+    static int bucketFor(TargetKind kind, CropType crop);
+    static int classify(const FarmGrid& grid, int tile);
+    int chunkOf(int tile) const;
+    void add(int bucket, int tile);
+    void remove(int tile);
+
+    int cols = 0;
+    int rows = 0;
+    int chunkCols = 0;
+    int chunkRows = 0;
+    float tileW = 1.f;
+    float tileH = 1.f;
+
+    std::vector<std::vector<int>> members; // [bucket * chunks + chunk] -> tiles
+    std::vector<int> bucketTotals;         // tiles per bucket
+    std::vector<std::int8_t> bucketOf;     // per tile, -1 if not filed
+    std::vector<int> slotOf;               // per tile, position inside its member list
+};